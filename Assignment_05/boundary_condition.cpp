@@ -1,6 +1,7 @@
 #include "boundary_condition.h"
 #include <cmath>
 #include <rarray>
+#include "fd_operators.h"
 
 // Applying the boundary conditions to the solution vector u
 void boundary_condition(rvector<double>& u, const double A, const double time){
@@ -12,7 +13,7 @@ void boundary_condition(rvector<double>& u, const double A, const double time){
 // Constructing the source term f(x,t) = u*(1 - u) for the Fisher-KPP reaction term
 void source_term(rvector<double>& f, const rvector<double>& u) {
     for (int i = 0; i < f.size(); i++) {
-        f[i] = u[i] * (1.0 - u[i]);  // Applying the Fisher-KPP reaction term
+        f[i] = fd::logistic_rate(u[i]);  // Applying the Fisher-KPP reaction term
     }
 }
 
@@ -7,11 +7,14 @@
 #include "calc_reaction.h"
 #include <cmath>
 #include <rarray>
+#include "fd_operators.h"
 
 /// @brief computes the timestep for the reaction term in the kpp-fisher equation exactly.
 
 void calc_reaction(const double dt, rvector<double>& u) {
+    // u/(u + (1-u)*exp(-dt)) from the shared operator library, with the exponential computed once
+    fd::LogisticStep step(dt);
     for (int i = 0; i < u.size(); i++) {
-        u[i] =  u[i]/ (u[i] + (1-u[i])*std::exp(-dt));
+        u[i] = step(u[i]);
     }
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+///@file bench_parse.cpp
+///@author Patrick Deng
+///@date April 9, 2025
+///@brief Microbenchmark of the conversion of text records: std::stoi against parse_records.
+/// Usage: ./bench_parse [number_of_records]
+/// The records are generated in memory, right-aligned like the data file, with step counts of 1 to 8 digits.
+
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <rarray>
+#include "stepfile.h"
+#include "record_parser.h"
+#include "ticktock.h"
+
+int main(int argc, char* argv[]){
+    long long n = (argc > 1) ? std::atoll(argv[1]) : 20000000;
+    // Generate the records: a uniform number of digits, so that short and long records are equally common.
+    rvector<char> buffer(n * text_record_length + 1);
+    std::mt19937 generator(2025);
+    std::uniform_int_distribution<int> digits(1, 8);
+    for (long long i = 0; i < n; i++){
+        int d = digits(generator);
+        int low = 1;
+        for (int k = 1; k < d; k++) low *= 10;
+        std::uniform_int_distribution<int> number(d == 1 ? 0 : low, 10 * low - 1);
+        std::snprintf(buffer.data() + i * text_record_length, text_record_length + 1, "%8d\n", number(generator));
+    }
+    rvector<std::uint32_t> with_stoi(n);
+    rvector<std::uint32_t> with_parser(n);
+
+    TickTock stopwatch;
+    stopwatch.tick();
+    for (long long i = 0; i < n; i++){
+        std::string record(buffer.data() + i * text_record_length, 8);
+        with_stoi[i] = std::stoi(record);
+    }
+    double stoi_time = stopwatch.silent_tock();
+
+    stopwatch.tick();
+    long long bad = parse_records(buffer.data(), n, with_parser.data());
+    double parser_time = stopwatch.silent_tock();
+
+    long long mismatches = 0;
+    for (long long i = 0; i < n; i++){
+        mismatches += (with_stoi[i] != with_parser[i]);
+    }
+    std::cout << "Records:        " << n << "\n";
+    std::cout << "std::stoi:      " << n / stoi_time / 1e6 << " million records/s\n";
+    std::cout << "parse_records:  " << n / parser_time / 1e6 << " million records/s\n";
+    std::cout << "Speedup:        " << stoi_time / parser_time << "\n";
+    std::cout << "Invalid records: " << (bad >= 0 ? 1 : 0) << ", mismatches: " << mismatches << std::endl;
+    return (bad >= 0 || mismatches > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,42 @@
+///@file binning.cpp
+///@author Patrick Deng
+///@date April 10, 2025
+///@brief This file contains the computation of the integer thresholds of the orders of the logarithm.
+
+#include <cmath>
+#include <limits>
+#include "binning.h"
+
+// The same expression as the logarithmic binning, so that both agree on every step count.
+int OrderBinning::order(std::uint32_t n, double base) {
+    return static_cast<int>(std::floor(std::log(n) / std::log(base)));
+}
+
+OrderBinning::OrderBinning(double base, std::uint32_t min_count, std::uint32_t max_count)
+    : first_order_(order(min_count, base)),
+      num_bins_(order(max_count, base) - order(min_count, base) + 1),
+      search_size_(1)
+{
+    while (search_size_ < num_bins_) {
+        search_size_ *= 2;
+    }
+    thresholds_ = rvector<std::uint64_t>(search_size_);
+    thresholds_.fill(std::numeric_limits<std::uint64_t>::max());
+    // Bin 0 starts at 0, so that the search never has to look below it.
+    thresholds_[0] = 0;
+    const std::uint64_t largest = std::numeric_limits<std::uint32_t>::max();
+    for (int b = 1; b < num_bins_; b++) {
+        int k = first_order_ + b;
+        // Start from ceil(base^k), which may be off by a little, and correct it with order()
+        // to the smallest step count of order k; the orders increase with the step count.
+        double estimate = std::ceil(std::pow(base, k));
+        std::uint64_t t = (estimate < 1) ? 1 : (estimate > largest) ? largest : static_cast<std::uint64_t>(estimate);
+        while (t > 1 && order(t - 1, base) >= k) {
+            t--;
+        }
+        while (t <= largest && order(t, base) < k) {
+            t++;
+        }
+        thresholds_[b] = t;
+    }
+}
@@ -0,0 +1,60 @@
+/// @file binning.h
+/// @brief Header file for binning the step counts by whole orders of the logarithm without computing logarithms.
+/// @author Patrick Deng
+/// @date April 10, 2025
+/// The histogram has one bin per order k of the logarithm, i.e. a step count n goes into bin
+/// floor(log(n)/log(base)). Because the step counts are integers, bin k holds exactly the integers
+/// from a threshold t_k = ceil(base^k) up to t_{k+1}-1. The thresholds are computed once, and each step
+/// count is binned by a binary search among them instead of two calls to std::log and a division.
+///
+/// The thresholds are not taken from base^k directly, but are corrected with the same floating-point
+/// expression as the logarithmic binning, so that the bins are identical also where that expression
+/// rounds across an order, e.g. log(1000)/log(10) = 2.9999999999999996 puts 1000 in order 2.
+#ifndef BINNING_H
+#define BINNING_H
+
+#include <cstdint>
+#include <rarray>
+
+/// @brief Bins step counts by the order of their logarithm, using precomputed integer thresholds.
+class OrderBinning {
+public:
+    /// @brief The order of the logarithm of a step count, computed with logarithms.
+    /// @param n The step count, at least 1.
+    /// @param base The base of the logarithm, larger than 1.
+    /// @return floor(log(n)/log(base))
+    static int order(std::uint32_t n, double base);
+
+    /// @brief Computes the thresholds of the orders of the step counts from min_count to max_count.
+    /// @param base The base of the logarithm, larger than 1.
+    /// @param min_count The smallest step count, at least 1.
+    /// @param max_count The largest step count.
+    OrderBinning(double base, std::uint32_t min_count, std::uint32_t max_count);
+
+    /// @brief The order of the first bin.
+    int first_order() const { return first_order_; }
+
+    /// @brief The number of bins, one per order from first_order().
+    int num_bins() const { return num_bins_; }
+
+    /// @brief The bin of a step count between min_count and max_count.
+    /// @details A binary search with a fixed number of steps that compiles to conditional moves.
+    /// @param n The step count.
+    /// @return order(n) - first_order()
+    int bin(std::uint32_t n) const {
+        const std::uint64_t* threshold = thresholds_.data();
+        int pos = 0;
+        for (int step = search_size_ / 2; step > 0; step /= 2) {
+            pos += (threshold[pos + step] <= n) ? step : 0;
+        }
+        return pos;
+    }
+
+private:
+    int first_order_;                     ///< order of bin 0
+    int num_bins_;                        ///< number of bins
+    int search_size_;                     ///< size of the threshold array, a power of two
+    rvector<std::uint64_t> thresholds_;   ///< smallest step count of each bin, padded with the largest value
+};
+
+#endif
@@ -0,0 +1,170 @@
+///@file convert_steps.cpp
+///@author Patrick Deng
+///@date April 8, 2025
+///@brief This program converts a text file of walker step counts into the packed binary format of stepfile.h.
+/// The conversion is done once, in parallel with MPI I/O: every process reads a contiguous range of whole blocks of the text file in chunks,
+/// converts the records to integers, computes the minimum and maximum of each block, and writes the values and its part of the block table
+/// collectively into the binary file. The histogram programs then read 4 instead of 9 bytes per record and need not parse them.
+
+#include <mpi.h>
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <limits>
+#include <rarray>
+#include "init.h"
+#include "stepfile.h"
+#include "record_parser.h"
+#include "ticktock.h"
+
+
+int main(int argc, char* argv[]){
+    //--------
+    // Initialize MPI environment
+    //--------
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    //--------
+    // Parse command line arguments and inspect the input file on the root process
+    //--------
+    ConvertParams params;
+    StepFileInfo info;
+    if (rank == 0) {
+        std::cout << "\n" << std::string(30, '=') << "Beginning Conversion"
+                  << std::string(30, '=') << "\n\n";
+        try {
+            params = parse_convert_arguments(argc, argv);
+            info = inspect_step_file(params.input);
+            if (info.binary) {
+                throw std::runtime_error("Input file " + params.input + " is already in the binary format");
+            }
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        std::cout << "Total number of processes: " << size << std::endl;
+    }
+    MPI_Bcast(&params.block_size, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&info, sizeof(info), MPI_BYTE, 0, MPI_COMM_WORLD);
+    // Broadcast both filenames: the root copies them into fixed-size buffers.
+    char input_buf[256], output_buf[256];
+    if (rank == 0) {
+        input_buf[params.input.copy(input_buf, 255)] = '\0';
+        output_buf[params.output.copy(output_buf, 255)] = '\0';
+    }
+    MPI_Bcast(input_buf, 256, MPI_CHAR, 0, MPI_COMM_WORLD);
+    MPI_Bcast(output_buf, 256, MPI_CHAR, 0, MPI_COMM_WORLD);
+    params.input = std::string(input_buf);
+    params.output = std::string(output_buf);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    TickTock stopwatch;
+    if (rank == 0){
+        stopwatch.tick();
+    }
+
+    //--------
+    // Distribute whole blocks over the processes, so each one can compute the table entries of its blocks.
+    // Without a table, the records are distributed evenly, as if in blocks of one record.
+    //--------
+    long long total_records = info.records;
+    long long nblocks = (params.block_size > 0) ? (total_records + params.block_size - 1) / params.block_size : 0;
+    if (nblocks > std::numeric_limits<std::uint32_t>::max()) {
+        if (rank == 0)
+            std::cerr << "Error: " << nblocks << " blocks do not fit the block table; use a larger block size." << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    long long unit = (params.block_size > 0) ? params.block_size : 1;        // records per unit of distribution
+    long long num_units = (total_records + unit - 1) / unit;
+    long long units_per_proc = num_units / size;
+    long long unit_remainder = num_units % size;
+    long long my_units = units_per_proc + (rank < unit_remainder ? 1 : 0);
+    long long first_unit = rank * units_per_proc + std::min<long long>(rank, unit_remainder);
+    long long first_record = std::min(first_unit * unit, total_records);
+    long long my_records = std::min((first_unit + my_units) * unit, total_records) - first_record;
+    long long max_records = (units_per_proc + (unit_remainder > 0 ? 1 : 0)) * unit;   // the largest portion
+    // Each process converts its portion in chunks of whole blocks of about a million records, in collective rounds
+    int chunk_size = (params.block_size > 0) ? std::max(1, (1 << 20) / params.block_size) * params.block_size : (1 << 20);
+    long long num_rounds = (max_records + chunk_size - 1) / chunk_size;
+
+    //--------
+    // Open both files; the root writes the header
+    //--------
+    StepFileHeader header;
+    std::copy(step_magic, step_magic + 8, header.magic);
+    header.byte_order = step_byte_order;
+    header.block_size = params.block_size;
+    header.records = total_records;
+    header.nblocks = nblocks;
+    header.reserved = 0;
+    MPI_Offset data_offset = sizeof(header) + 2 * sizeof(std::uint32_t) * static_cast<MPI_Offset>(nblocks);
+    MPI_File fin, fout;
+    if (MPI_File_open(MPI_COMM_WORLD, params.input.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fin) != MPI_SUCCESS) {
+        if (rank == 0)
+            std::cerr << "Error opening file " << params.input << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    if (MPI_File_open(MPI_COMM_WORLD, params.output.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fout) != MPI_SUCCESS) {
+        if (rank == 0)
+            std::cerr << "Error opening file " << params.output << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    // Truncate whatever an existing file held beyond the new data
+    MPI_File_set_size(fout, data_offset + static_cast<MPI_Offset>(total_records) * sizeof(std::uint32_t));
+    if (rank == 0) {
+        MPI_File_write_at(fout, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+
+    //--------
+    // Read, convert and write this process's records chunk by chunk, with the table entries of the chunk's blocks
+    //--------
+    MPI_Datatype record_type;       // a text record, so that counts are in records
+    MPI_Type_contiguous(text_record_length, MPI_CHAR, &record_type);
+    MPI_Type_commit(&record_type);
+    rvector<char> buffer(static_cast<long long>(chunk_size) * text_record_length);
+    rvector<std::uint32_t> values(chunk_size);
+    int max_table = (params.block_size > 0) ? chunk_size / params.block_size : 1;
+    rmatrix<std::uint32_t> table(max_table, 2);
+    for (long long round = 0; round < num_rounds; round++){
+        long long first = first_record + round * chunk_size;     // index of the first record of the chunk
+        int n = static_cast<int>(std::max(0LL, std::min<long long>(chunk_size, first_record + my_records - first)));
+        MPI_File_read_at_all(fin, static_cast<MPI_Offset>(first) * text_record_length, buffer.data(), n, record_type, MPI_STATUS_IGNORE);
+        long long bad = parse_records(buffer.data(), n, values.data());
+        if (bad >= 0) {
+            std::cerr << "Error: Cannot convert record '" << std::string(buffer.data() + bad * text_record_length, 8)
+                      << "' at index " << first + bad << " to a step count." << std::endl;
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        // Minimum and maximum of each of the chunk's blocks; a chunk starts at a block boundary
+        int my_table = (params.block_size > 0) ? (n + params.block_size - 1) / params.block_size : 0;
+        for (int b = 0; b < my_table; b++){
+            int begin = b * params.block_size;
+            int end = std::min(begin + params.block_size, n);
+            table[b][0] = *std::min_element(values.data() + begin, values.data() + end);
+            table[b][1] = *std::max_element(values.data() + begin, values.data() + end);
+        }
+        long long first_entry = (params.block_size > 0) ? first / params.block_size : 0;
+        MPI_File_write_at_all(fout, sizeof(header) + 2 * sizeof(std::uint32_t) * static_cast<MPI_Offset>(first_entry),
+                              table.data(), 2 * my_table, MPI_UINT32_T, MPI_STATUS_IGNORE);
+        MPI_File_write_at_all(fout, data_offset + static_cast<MPI_Offset>(first) * sizeof(std::uint32_t),
+                              values.data(), n, MPI_UINT32_T, MPI_STATUS_IGNORE);
+    }
+    MPI_Type_free(&record_type);
+    MPI_File_close(&fin);
+    MPI_File_close(&fout);
+
+    if (rank == 0) {
+        std::cout << "\nConverted " << total_records << " records in " << header.nblocks << " blocks\n";
+        stopwatch.tock("\nTotal time:     ");
+        std::cout << "\n" << std::string(30, '=')
+                  << "Conversion Complete" << std::string(30, '=') << "\n\n";
+    }
+
+    MPI_Finalize();
+    return 0;
+}
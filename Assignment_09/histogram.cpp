@@ -0,0 +1,99 @@
+///@file histogram.cpp
+///@author Patrick Deng
+///@date April 11, 2025
+///@brief This file contains the reduction and the output of the histogram of the orders of the logarithm.
+
+#include <iostream>
+#include <utility>
+#include "histogram.h"
+
+OrderHistogram::OrderHistogram(double base, std::uint32_t min_count, std::uint32_t max_count)
+    : OrderHistogram(std::make_shared<const OrderBinning>(base, min_count, max_count), min_count, max_count)
+{
+}
+
+OrderHistogram::OrderHistogram(std::shared_ptr<const OrderBinning> binning, std::uint32_t min_count, std::uint32_t max_count)
+    : binning_(std::move(binning)),
+      min_count_(min_count),
+      max_count_(max_count),
+      counts_(binning_->num_bins()),
+      zeros_(0),
+      out_of_range_(0)
+{
+    counts_.fill(0);
+}
+
+OrderHistogram OrderHistogram::empty_copy() const {
+    return OrderHistogram(binning_, min_count_, max_count_);
+}
+
+void OrderHistogram::merge(const OrderHistogram& other) {
+    for (int b = 0; b < binning_->num_bins(); b++){
+        counts_[b] += other.counts_[b];
+    }
+    zeros_ += other.zeros_;
+    out_of_range_ += other.out_of_range_;
+}
+
+std::map<int, long long> OrderHistogram::sparse() const {
+    std::map<int, long long> hist;
+    for (int b = 0; b < binning_->num_bins(); b++){
+        if (counts_[b] > 0)
+            hist[binning_->first_order() + b] = counts_[b];
+    }
+    return hist;
+}
+
+// Gather the (order, count) pairs of all processes on the root and add them up there.
+std::map<int, long long> OrderHistogram::reduce(int root, MPI_Comm comm) const {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    std::map<int, long long> local = sparse();
+    int npairs = local.size();
+    rvector<int> orders(npairs + 1);
+    rvector<long long> counts(npairs + 1);
+    int i = 0;
+    for (const auto& [order, count] : local){
+        orders[i] = order;
+        counts[i] = count;
+        i++;
+    }
+    rvector<int> all_npairs(size);
+    MPI_Gather(&npairs, 1, MPI_INT, all_npairs.data(), 1, MPI_INT, root, comm);
+    rvector<int> displs(size);
+    int total_pairs = 0;
+    if (rank == root) {
+        for (int r = 0; r < size; r++){
+            displs[r] = total_pairs;
+            total_pairs += all_npairs[r];
+        }
+    }
+    rvector<int> all_orders(total_pairs + 1);
+    rvector<long long> all_counts(total_pairs + 1);
+    MPI_Gatherv(orders.data(), npairs, MPI_INT, all_orders.data(), all_npairs.data(), displs.data(), MPI_INT, root, comm);
+    MPI_Gatherv(counts.data(), npairs, MPI_LONG_LONG, all_counts.data(), all_npairs.data(), displs.data(), MPI_LONG_LONG, root, comm);
+    std::map<int, long long> hist;
+    for (int p = 0; p < total_pairs; p++){
+        hist[all_orders[p]] += all_counts[p];
+    }
+    return hist;
+}
+
+// The orders between the first and the last that occur are printed too, with a fraction of 0.
+void print_histogram(const std::map<int, long long>& hist) {
+    long long total_count = 0;
+    for (const auto& [order, count] : hist){
+        total_count += count;
+    }
+    std::cout << "\nHistogram (log bin start, fraction):\n";
+    if (hist.empty()) {
+        return;
+    }
+    for (int order = hist.begin()->first; order <= hist.rbegin()->first; order++){
+        auto bin = hist.find(order);
+        double count = (bin != hist.end()) ? bin->second : 0;
+        double fraction = count / total_count;
+        std::cout << order << "    " << fraction << "\n";
+    }
+}
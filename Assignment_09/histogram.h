@@ -0,0 +1,78 @@
+/// @file histogram.h
+/// @brief Header file for the histogram of the orders of the logarithm of the step counts.
+/// @author Patrick Deng
+/// @date April 11, 2025
+/// The histogram can be filled chunk by chunk as the data streams in, because it does not need to know
+/// the smallest and largest step count beforehand: the binning covers all step counts a record can hold
+/// (or the range given by the block table of a binary file). Only the orders that occur are reduced,
+/// as (order, count) pairs, so the reduction is as small as the histogram however wide the binning is.
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <mpi.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <rarray>
+#include "binning.h"
+
+/// @brief Counts of step counts per order of the logarithm, filled in chunks.
+class OrderHistogram {
+public:
+    /// @brief An empty histogram for step counts from min_count to max_count.
+    /// @param base The base of the logarithm, larger than 1.
+    /// @param min_count The smallest possible step count, at least 1.
+    /// @param max_count The largest possible step count.
+    OrderHistogram(double base, std::uint32_t min_count, std::uint32_t max_count);
+
+    /// @brief An empty histogram with the same base and range, e.g. for a thread.
+    /// @details The thresholds of the binning are shared, read only, rather than computed again; only the counts are new.
+    OrderHistogram empty_copy() const;
+
+    /// @brief Adds step counts to the histogram.
+    /// @param steps The step counts.
+    /// @param n The number of step counts.
+    void add(const std::uint32_t* steps, long long n) {
+        const OrderBinning& binning = *binning_;
+        for (long long i = 0; i < n; i++) {
+            bool zero = (steps[i] == 0);
+            counts_[binning.bin(steps[i])] += !zero;
+            zeros_ += zero;
+            out_of_range_ += (!zero) & ((steps[i] < min_count_) | (steps[i] > max_count_));
+        }
+    }
+
+    /// @brief The number of step counts of 0 added, which have no logarithm and are left out of the histogram.
+    long long zeros() const { return zeros_; }
+
+    /// @brief The number of nonzero step counts added outside the range of the histogram.
+    long long out_of_range() const { return out_of_range_; }
+
+    /// @brief Adds the counts of another histogram, e.g. of another thread, with the same base and range.
+    /// @param other The histogram to add.
+    void merge(const OrderHistogram& other);
+
+    /// @brief The counts of the orders that occur, on this process.
+    std::map<int, long long> sparse() const;
+
+    /// @brief The counts of the orders that occur on any process, summed on the root.
+    /// @param root The rank that receives the sum; the other ranks get an empty map.
+    /// @param comm The communicator.
+    std::map<int, long long> reduce(int root, MPI_Comm comm) const;
+
+private:
+    OrderHistogram(std::shared_ptr<const OrderBinning> binning, std::uint32_t min_count, std::uint32_t max_count);
+
+    std::shared_ptr<const OrderBinning> binning_;   ///< the thresholds of the orders, shared by the copies of empty_copy()
+    std::uint32_t min_count_;                       ///< smallest step count in range
+    std::uint32_t max_count_;                       ///< largest step count in range
+    rvector<long long> counts_;                     ///< count per bin of the binning
+    long long zeros_;                               ///< step counts of 0
+    long long out_of_range_;                        ///< nonzero step counts outside [min_count_, max_count_]
+};
+
+/// @brief Prints the normalized histogram, one line per order from the first to the last that occurs.
+/// @param hist The counts per order.
+void print_histogram(const std::map<int, long long>& hist);
+
+#endif
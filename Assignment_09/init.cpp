@@ -7,15 +7,25 @@
 #include <iostream>
 #include "init.h"
 
-///@param base The base of the logarithm 
+///@param base The base of the logarithm, larger than 1
 ///@param file The filename of the input data
 ///@param batch_size The batchsize for each process to compute at a time
-// Function to parse command-line arguments (executed on rank 0).
-SimulationParams parse_arguments(int argc, char* argv[]) {
+///@param parse_on_workers Where mpi_scatter converts the text records: "root" or "workers"
+///@param cb_buffer_size The MPI I/O hint cb_buffer_size of mpi_parallel_io
+///@param romio_cb_read The MPI I/O hint romio_cb_read of mpi_parallel_io
+///@param sketch_k The accuracy parameter of the quantile sketch, 0 (no quantiles) by default
+// Function to parse command-line arguments (executed on rank 0). Only mpi_scatter takes -parse,
+// and only the programs that read with MPI I/O take the hints.
+SimulationParams parse_arguments(int argc, char* argv[], bool scatter) {
     SimulationParams params;
     params.base = -1;
     params.file = "";
     params.batch_size = -1;
+    params.parse_on_workers = 0;
+    params.cb_buffer_size = "";
+    params.romio_cb_read = "";
+    params.sketch_k = 0;
+    bool parse_given = false;
     for (int i = 1; i < argc; i++) {
         std::string flag(argv[i]);
         if (i+1 >= argc) {
@@ -28,14 +38,78 @@ SimulationParams parse_arguments(int argc, char* argv[]) {
             params.file = value;
         } else if (flag == "-batch") {
             params.batch_size = std::stoi(value);
+        } else if (flag == "-parse" && scatter) {
+            if (value != "root" && value != "workers") {
+                throw std::runtime_error("Invalid value for -parse: " + value + " (root or workers)");
+            }
+            params.parse_on_workers = (value == "workers");
+            parse_given = true;
+        } else if (flag == "-cb_buffer_size" && !scatter) {
+            if (std::stol(value) <= 0) {
+                throw std::runtime_error("Invalid value for -cb_buffer_size: " + value);
+            }
+            params.cb_buffer_size = value;
+        } else if (flag == "-romio_cb_read" && !scatter) {
+            if (value != "enable" && value != "disable" && value != "automatic") {
+                throw std::runtime_error("Invalid value for -romio_cb_read: " + value + " (enable, disable or automatic)");
+            }
+            params.romio_cb_read = value;
+        } else if (flag == "-sketch_k") {
+            params.sketch_k = std::stoi(value);
+            if (params.sketch_k != 0 && (params.sketch_k < 8 || params.sketch_k > 1000000)) {
+                throw std::runtime_error("Invalid value for -sketch_k: " + value + " (0, or 8 to 1000000)");
+            }
+        } else if (flag == "-parse" || flag == "-cb_buffer_size" || flag == "-romio_cb_read") {
+            throw std::runtime_error(flag + " is not an option of " + argv[0]);
         } else {
             throw std::runtime_error("Unknown flag " + flag);
         }
     }
-    if (params.base <= 0 || params.file.empty() || params.batch_size <= 0) {
-        throw std::runtime_error("Usage: mpirun -np <procs> ./mpi_hist_scatter -base <log_base> -filename <data_file> -batch <batch_size>");
+    if (params.base <= 1 || params.file.empty() || params.batch_size <= 0) {
+        throw std::runtime_error(std::string("Usage: mpirun -np <procs> ") + argv[0] + " -base <log_base> -filename <data_file> -batch <batch_size>"
+                                 + (scatter ? " [-parse <root|workers>]" : " [-cb_buffer_size <bytes>] [-romio_cb_read <enable|disable|automatic>]")
+                                 + " [-sketch_k <k>]");
     }
     std::cout << "Using base: " << params.base << "\nFile: " << params.file 
               << "\nBatch size: " << params.batch_size << std::endl;
+    if (parse_given) {
+        std::cout << "Parsing on: " << (params.parse_on_workers ? "workers" : "root") << std::endl;
+    }
+    if (params.sketch_k > 0) {
+        std::cout << "Quantile sketch k: " << params.sketch_k << std::endl;
+    }
+    return params;
+}
+
+///@param input The filename of the text data
+///@param output The filename of the binary data to write
+///@param block_size The number of step counts per block of the block table
+// Function to parse the command-line arguments of the converter (executed on rank 0).
+ConvertParams parse_convert_arguments(int argc, char* argv[]) {
+    ConvertParams params;
+    params.input = "";
+    params.output = "";
+    params.block_size = 65536;
+    for (int i = 1; i < argc; i++) {
+        std::string flag(argv[i]);
+        if (i+1 >= argc) {
+            throw std::runtime_error("Missing value for " + flag);
+        }
+        std::string value(argv[++i]);
+        if (flag == "-input") {
+            params.input = value;
+        } else if (flag == "-output") {
+            params.output = value;
+        } else if (flag == "-block") {
+            params.block_size = std::stoi(value);
+        } else {
+            throw std::runtime_error("Unknown flag " + flag);
+        }
+    }
+    if (params.input.empty() || params.output.empty() || params.block_size < 0) {
+        throw std::runtime_error("Usage: mpirun -np <procs> ./convert_steps -input <text_file> -output <binary_file> [-block <block_size>]");
+    }
+    std::cout << "Input: " << params.input << "\nOutput: " << params.output
+              << "\nBlock size: " << params.block_size << std::endl;
     return params;
-}
\ No newline at end of file
+}
@@ -14,18 +14,45 @@
 /// @param base Base of the logarithm
 /// @param file Name of the input file
 /// @param batch_size Size of the batch for processing
+/// @param parse_on_workers Whether mpi_scatter sends the text records unconverted, for every process to convert its own (0 or 1)
+/// @param cb_buffer_size MPI I/O hint for the collective buffer size in bytes of mpi_parallel_io (empty for the default)
+/// @param romio_cb_read MPI I/O hint for collective buffering of reads of mpi_parallel_io: enable, disable or automatic (empty for the default)
+/// @param sketch_k Accuracy parameter k of the quantile sketch (0 for no quantiles)
 struct SimulationParams {
     double base;
     std::string file;
     int batch_size;
+    int parse_on_workers;
+    std::string cb_buffer_size;
+    std::string romio_cb_read;
+    int sketch_k;
 };
 
 /// @brief Parses command-line arguments and returns a SimulationParams struct.
 /// @param argc Number of command-line arguments.
 /// @param argv Array of command-line argument strings.
+/// @param scatter Whether these are the options of mpi_scatter, which takes -parse, or of the programs
+/// that read with MPI I/O, which take -cb_buffer_size and -romio_cb_read instead.
 /// @return A struct containing parsed simulation parameters.
+/// @throws std::runtime_error if any required argument is missing or invalid, or belongs to the other programs.
+SimulationParams parse_arguments(int argc, char* argv[], bool scatter);
+
+/// @brief Structure to store the command-line inputs of the converter.
+/// @param input Name of the text file to convert
+/// @param output Name of the binary file to write
+/// @param block_size Number of step counts per block of the block table (0 for no table)
+struct ConvertParams {
+    std::string input;
+    std::string output;
+    int block_size;
+};
+
+/// @brief Parses the command-line arguments of convert_steps.
+/// @param argc Number of command-line arguments.
+/// @param argv Array of command-line argument strings.
+/// @return A struct containing the parsed converter parameters.
 /// @throws std::runtime_error if any required argument is missing or invalid.
-SimulationParams parse_arguments(int argc, char* argv[]);
+ConvertParams parse_convert_arguments(int argc, char* argv[]);
 
 #endif
 
@@ -0,0 +1,65 @@
+///@file make_large_test.cpp
+///@author Patrick Deng
+///@date April 12, 2025
+///@brief Writes a binary step file with more records than a 32-bit int can count, for testing the 64-bit record counts.
+/// Usage: ./make_large_test <output_file> [number_of_records]
+/// Only four regions of 1000 records are written: at the start, across record 2^31, across record 2^32 and at the end.
+/// The rest of the file is a hole, which reads as step counts of 0 and takes no disk space on file systems with sparse files.
+/// The regions hold the step counts 5, 40, 300 and 3000, one per order of the logarithm in base 10, so the expected
+/// output is a quarter in each of the orders 0 to 3, with all other records left out as 0. It is printed to standard output.
+
+#include <iostream>
+#include <fstream>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <rarray>
+#include "stepfile.h"
+
+int main(int argc, char* argv[]){
+    if (argc < 2) {
+        std::cerr << "Usage: ./make_large_test <output_file> [number_of_records]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const long long region = 1000;
+    long long n = (argc > 2) ? std::atoll(argv[2]) : 4300000000LL;
+    if (n < 4 * region) {
+        std::cerr << "Error: the file needs at least " << 4 * region << " records." << std::endl;
+        return EXIT_FAILURE;
+    }
+    StepFileHeader header;
+    std::copy(step_magic, step_magic + 8, header.magic);
+    header.byte_order = step_byte_order;
+    header.block_size = 0;
+    header.records = n;
+    header.nblocks = 0;
+    header.reserved = 0;
+    std::ofstream file(argv[1], std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // The first record of each region, kept apart and in increasing order, and its step count
+    const long long starts[4] = {0,
+                                 std::clamp((1LL << 31) - region / 2, region, n - 3 * region),
+                                 std::clamp((1LL << 32) - region / 2, 2 * region, n - 2 * region),
+                                 n - region};
+    const std::uint32_t values[4] = {5, 40, 300, 3000};
+    rvector<std::uint32_t> steps(region);
+    for (int r = 0; r < 4; r++){
+        steps.fill(values[r]);
+        file.seekp(sizeof(header) + starts[r] * sizeof(std::uint32_t));
+        file.write(reinterpret_cast<const char*>(steps.data()), region * sizeof(std::uint32_t));
+    }
+    file.close();
+    if (!file) {
+        std::cerr << "Error writing " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // The expected output of mpi_scatter and mpi_parallel_io with -base 10
+    std::cout << "Left out " << n - 4 * region << " step counts of 0, which have no logarithm.\n";
+    std::cout << "Histogram (log bin start, fraction):\n";
+    for (int order = 0; order < 4; order++){
+        std::cout << order << "    " << 0.25 << "\n";
+    }
+    return EXIT_SUCCESS;
+}
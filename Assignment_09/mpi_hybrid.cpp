@@ -0,0 +1,292 @@
+///@file mpi_hybrid.cpp
+///@author Patrick Deng
+///@date April 14, 2025
+///@brief The hybrid MPI and OpenMP version of mpi_parallel_io: a few processes per node, each with several threads.
+/// Each process reads its portion of the file collectively in chunks, as in mpi_parallel_io, but only its master thread does the I/O,
+/// so there are as many I/O clients and copies of the buffers per node as processes, not as cores. The chunks are converted and binned
+/// by all threads of the process, each into its own histogram and quantile sketch, which are merged within the process before the
+/// MPI reduction. While the threads bin one chunk, the master thread reads the next one into a second buffer and then joins them.
+/// The number of threads per process is set with OMP_NUM_THREADS.
+
+#include <mpi.h>
+#include <omp.h>
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <rarray> 
+#include "init.h"
+#include "histogram.h"
+#include "quantile_sketch.h"
+#include "stepfile.h"
+#include "record_parser.h"
+#include "ticktock.h"
+
+
+int main(int argc, char* argv[]){
+    //--------
+    // Initialize MPI environment
+    //--------
+    // Only the master thread of each process calls MPI.
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    //--------
+    // Parse command line arguments
+    //--------
+    SimulationParams params;
+    StepFileInfo info;
+    if (rank == 0) {
+        std::cout << "\n" << std::string(30, '=') << "Beginning Hybrid Calculation" 
+                  << std::string(30, '=') << "\n\n";
+        if (provided < MPI_THREAD_FUNNELED) {
+            std::cerr << "Error: The MPI library does not support threads." << std::endl;
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        try {
+            params = parse_arguments(argc, argv, false);
+            info = inspect_step_file(params.file);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        std::cout << "Format: " << (info.binary ? "binary" : "text") << std::endl;
+        std::cout << "Total number of processes: " << size << std::endl;
+        std::cout << "Threads per process: " << omp_get_max_threads() << std::endl;
+    }
+    // Broadcast parameters to all processes.
+    MPI_Bcast(&params.base, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    // The batch size is the number of records each process reads per round.
+    MPI_Bcast(&params.batch_size, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&params.sketch_k, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    // The layout of the file is plain data and is broadcast as bytes.
+    MPI_Bcast(&info, sizeof(info), MPI_BYTE, 0, MPI_COMM_WORLD);
+
+    // Broadcast filename: send its length then the string.
+    int filename_length = 0;
+    if (rank == 0) {
+        filename_length = params.file.size();
+    }
+    MPI_Bcast(&filename_length, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    char filename_buf[256];
+    if (rank == 0) {
+        std::copy(params.file.begin(), params.file.end(), filename_buf);
+        filename_buf[filename_length] = '\0';
+    }
+    MPI_Bcast(filename_buf, 256, MPI_CHAR, 0, MPI_COMM_WORLD);
+    if (rank != 0) {
+        params.file = std::string(filename_buf);
+    }
+    // Broadcast the hints the same way; they are short.
+    char hint_buf[2][64];
+    if (rank == 0) {
+        hint_buf[0][params.cb_buffer_size.copy(hint_buf[0], 63)] = '\0';
+        hint_buf[1][params.romio_cb_read.copy(hint_buf[1], 63)] = '\0';
+    }
+    MPI_Bcast(hint_buf, 2 * 64, MPI_CHAR, 0, MPI_COMM_WORLD);
+    params.cb_buffer_size = std::string(hint_buf[0]);
+    params.romio_cb_read = std::string(hint_buf[1]);
+
+    // Synchronize and start the timer.
+    MPI_Barrier(MPI_COMM_WORLD);
+    TickTock stopwatch;
+    if (rank == 0){
+        stopwatch.tick();
+    }
+
+    //--------
+    // Open the data file collectively using MPI I/O for each process, with the hints given on the command line
+    //--------
+    MPI_Info hints;
+    MPI_Info_create(&hints);
+    if (!params.cb_buffer_size.empty())
+        MPI_Info_set(hints, "cb_buffer_size", params.cb_buffer_size.c_str());
+    if (!params.romio_cb_read.empty())
+        MPI_Info_set(hints, "romio_cb_read", params.romio_cb_read.c_str());
+    MPI_File fh;            // file handle for mpi in parallel I/O
+    int ret = MPI_File_open(MPI_COMM_WORLD, params.file.c_str(), MPI_MODE_RDONLY, hints, &fh);      // open the file
+    if (ret != MPI_SUCCESS) {       // error handling to check if the file is correctly opened  
+        if (rank == 0)
+            std::cerr << "Error opening file " << params.file << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    // The number of records follows from the file size (text) or the header (binary)
+    long long total_records = info.records;
+
+    //--------
+    // Compute the number of records for each process
+    //--------
+    long long records_per_proc = total_records / size;            // Get the number of records for each process
+    long long remainder = total_records % size;                   // Remainder records
+    long long my_records = records_per_proc + (rank < remainder ? 1 : 0);     // The record that is assigned to this process
+    // Compute the starting record offset for this process.
+    long long offset_records = (rank < remainder)             // if rank is less than remainder
+                           ? rank * (records_per_proc + 1)      // each process gets one more record
+                           : remainder * (records_per_proc + 1) + (rank - remainder) * records_per_proc;        // otherwise the remaining records are distributed evenly
+
+    //--------
+    // The range of the histogram: all step counts of 8 digits (text) or 32 bits (binary), or the range in the block table of a binary file
+    //--------
+    std::uint32_t range[2] = {1, info.binary ? std::numeric_limits<std::uint32_t>::max() : text_max_count};
+    if (info.nblocks > 0) {
+        if (rank == 0) {
+            rmatrix<std::uint32_t> blocks = read_block_table(params.file, info);
+            range[0] = blocks[0][0];
+            range[1] = blocks[0][1];
+            for (long long b = 1; b < info.nblocks; b++){
+                range[0] = std::min(range[0], blocks[b][0]);
+                range[1] = std::max(range[1], blocks[b][1]);
+            }
+            range[0] = std::max<std::uint32_t>(range[0], 1);    // a 0 is not binned
+        }
+        MPI_Bcast(range, 2, MPI_UINT32_T, 0, MPI_COMM_WORLD);
+    }
+    // The histogram and the quantile sketch of this process, merged from those of its threads
+    OrderHistogram histogram(params.base, range[0], range[1]);
+    bool use_sketch = params.sketch_k > 0;
+    QuantileSketch sketch(std::max(params.sketch_k, 8), rank);
+
+    //--------
+    // View the file as a sequence of records from the first one on: a text record is a contiguous type of 9 characters,
+    // a binary record a uint32. Offsets and counts of the reads are then in records.
+    //--------
+    MPI_Datatype record_type = MPI_UINT32_T;
+    if (!info.binary) {
+        MPI_Type_contiguous(text_record_length, MPI_CHAR, &record_type);
+        MPI_Type_commit(&record_type);
+    }
+    MPI_File_set_view(fh, info.data_offset, record_type, record_type, "native", hints);
+    MPI_Info_free(&hints);
+    if (rank == 0) {
+        // Report the hints in effect, which the MPI library may have adjusted
+        MPI_Info used;
+        MPI_File_get_info(fh, &used);
+        for (const char* key : {"cb_buffer_size", "romio_cb_read"}) {
+            char value[MPI_MAX_INFO_VAL + 1];
+            int found = 0;
+            MPI_Info_get(used, key, MPI_MAX_INFO_VAL, value, &found);
+            std::cout << key << ": " << (found ? value : "(not supported)") << std::endl;
+        }
+        MPI_Info_free(&used);
+    }
+
+    //--------
+    // Stream through this process's portion in chunks of batch_size records, in collective rounds as in mpi_parallel_io, with two buffers:
+    // in each round the master thread reads the next chunk while the other threads convert and bin the current one. A chunk is handed
+    // out to the threads in blocks, so the master takes fewer blocks when its read takes longer.
+    //--------
+    long long max_records = records_per_proc + (remainder > 0 ? 1 : 0);                  // the largest portion
+    int chunk_size = static_cast<int>(std::min<long long>(params.batch_size, std::max(max_records, 1LL)));
+    long long num_rounds = (max_records + chunk_size - 1) / chunk_size;
+    const int block_size = 16384;                                                         // records per block of a chunk
+    rmatrix<std::uint32_t> values(info.binary ? 2 : 1, info.binary ? chunk_size : 1);
+    rmatrix<char> text(info.binary ? 1 : 2, info.binary ? 1 : static_cast<long long>(chunk_size) * text_record_length);
+    auto chunk_records = [&](long long round) {
+        return static_cast<int>(std::max(0LL, std::min<long long>(chunk_size, my_records - round * chunk_size)));
+    };
+    auto read_chunk = [&](long long round) {
+        MPI_Offset offset = offset_records + round * chunk_size;      // in records, relative to the view
+        void* buffer = info.binary ? static_cast<void*>(&values[round % 2][0]) : static_cast<void*>(&text[round % 2][0]);
+        MPI_File_read_at_all(fh, offset, buffer, chunk_records(round), record_type, MPI_STATUS_IGNORE);
+    };
+    if (num_rounds > 0) {
+        read_chunk(0);
+    }
+    long long first_bad = -1;               // index of the first invalid record found, if any
+    std::string bad_record;
+    #pragma omp parallel
+    {
+        // Thread-private counts and sketch, merged into those of the process at the end; the thresholds of the binning are shared
+        OrderHistogram thread_histogram = histogram.empty_copy();
+        QuantileSketch thread_sketch(std::max(params.sketch_k, 8), static_cast<std::uint64_t>(rank) * omp_get_num_threads() + omp_get_thread_num());
+        rvector<std::uint32_t> steps(info.binary ? 1 : block_size);
+        for (long long round = 0; round < num_rounds; round++){
+            int n = chunk_records(round);
+            #pragma omp master
+            {
+                // The buffer of the next chunk was done with in the previous round.
+                if (round + 1 < num_rounds) {
+                    read_chunk(round + 1);
+                }
+            }
+            // The implicit barrier at the end also waits for the read of the master.
+            #pragma omp for schedule(dynamic)
+            for (int begin = 0; begin < n; begin += block_size){
+                int count = std::min(block_size, n - begin);
+                const std::uint32_t* block;
+                if (info.binary) {
+                    block = &values[round % 2][begin];
+                } else {
+                    // Convert records to integers. Each record is 8 characters and a newline.
+                    const char* records = &text[round % 2][0] + static_cast<long long>(begin) * text_record_length;
+                    long long bad = parse_records(records, count, steps.data());
+                    if (bad >= 0) {
+                        #pragma omp critical (bad_record)
+                        {
+                            long long index = offset_records + round * chunk_size + begin + bad;
+                            if (first_bad < 0 || index < first_bad) {
+                                first_bad = index;
+                                bad_record = std::string(records + bad * text_record_length, 8);
+                            }
+                        }
+                    }
+                    block = steps.data();
+                }
+                thread_histogram.add(block, count);
+                if (use_sketch)
+                    thread_sketch.add(block, count);
+            }
+        }
+        #pragma omp critical (merge)
+        {
+            histogram.merge(thread_histogram);
+            if (use_sketch)
+                sketch.merge(thread_sketch);
+        }
+    }
+    if (first_bad >= 0) {
+        std::cerr << "Error: Cannot convert record '" << bad_record << "' at index " << first_bad << " to integer." << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_File_close(&fh);
+    if (!info.binary) {
+        MPI_Type_free(&record_type);
+    }
+    if (histogram.out_of_range() > 0) {
+        std::cerr << "Error: " << histogram.out_of_range() << " step counts are outside the range of the block table." << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    // Step counts of 0 have no logarithm; they are left out of the histogram and reported.
+    long long my_zeros = histogram.zeros();
+    long long total_zeros = 0;
+    MPI_Reduce(&my_zeros, &total_zeros, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    //--------
+    // Reduce the orders that occur on each process, summed over its threads, to a global histogram on the root process
+    //--------
+    std::map<int, long long> global_hist = histogram.reduce(0, MPI_COMM_WORLD);
+    // Merge the quantile sketches of all processes, each merged from its threads, on the root process
+    QuantileSketch global_sketch = use_sketch ? sketch.reduce(0, MPI_COMM_WORLD) : sketch;
+    
+    // Root process normalizes and prints the histogram and timing
+    if (rank == 0) {
+        if (total_zeros > 0)
+            std::cout << "\nLeft out " << total_zeros << " step counts of 0, which have no logarithm." << std::endl;
+        print_histogram(global_hist);
+        if (use_sketch)
+            print_quantiles(global_sketch);
+        stopwatch.tock("\nTotal time:     ");
+        std::cout << "\n" << std::string(30, '=') 
+                  << "Calculation Complete" << std::string(30, '=') << "\n\n";
+    }
+    
+    MPI_Finalize();
+    return 0;
+}
\ No newline at end of file
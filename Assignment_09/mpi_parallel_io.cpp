@@ -1,8 +1,12 @@
 ///@file mpi_parallel_io.cpp
 ///@author Patrick Deng
 ///@date April 3, 2025
-///@brief This program reads a file containing integer records, computes the logarithm of each record, and generates a histogram of the log values using MPI for parallel processing.
+///@brief This program reads a file containing integer records, and generates a histogram of the logarithm of the records using MPI for parallel processing.
 /// The program is designed to be run in a distributed environment using MPI with with parallel io where Each process opens the file collectively and reads its own designated portion concurrently using MPI I/O .
+/// The file can be text or in the packed binary format of stepfile.h; binary records need no conversion, and the block table gives the range of the step counts.
+/// Each process streams through its portion in chunks of batch_size records, which are converted and binned right after they are read, into a histogram keyed by order
+/// that needs no global minimum and maximum beforehand. The chunks are read collectively, in rounds in which all processes read their next chunk together,
+/// through a file view in units of records; the MPI I/O hints cb_buffer_size and romio_cb_read can be set on the command line.
 
 #include <mpi.h>
 #include <iostream>
@@ -11,8 +15,14 @@
 #include <string>
 #include <cstdlib>
 #include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <rarray> 
 #include "init.h"
+#include "histogram.h"
+#include "quantile_sketch.h"
+#include "stepfile.h"
+#include "record_parser.h"
 #include "ticktock.h"
 
 
@@ -29,21 +39,27 @@ int main(int argc, char* argv[]){
     // Parse command line arguments
     //--------
     SimulationParams params;
+    StepFileInfo info;
     if (rank == 0) {
         std::cout << "\n" << std::string(30, '=') << "Beginning Parallel I/O Calculation" 
                   << std::string(30, '=') << "\n\n";
         try {
-            params = parse_arguments(argc, argv);
+            params = parse_arguments(argc, argv, false);
+            info = inspect_step_file(params.file);
         } catch (const std::runtime_error& e) {
             std::cerr << e.what() << std::endl;
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
+        std::cout << "Format: " << (info.binary ? "binary" : "text") << std::endl;
         std::cout << "Total number of processes: " << size << std::endl;
     }
     // Broadcast parameters to all processes.
     MPI_Bcast(&params.base, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    // The batch size may not be needed here but we broadcast it for consistency.
+    // The batch size is the number of records each process reads per round.
     MPI_Bcast(&params.batch_size, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&params.sketch_k, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    // The layout of the file is plain data and is broadcast as bytes.
+    MPI_Bcast(&info, sizeof(info), MPI_BYTE, 0, MPI_COMM_WORLD);
 
     // Broadcast filename: send its length then the string.
     int filename_length = 0;
@@ -60,6 +76,15 @@ int main(int argc, char* argv[]){
     if (rank != 0) {
         params.file = std::string(filename_buf);
     }
+    // Broadcast the hints the same way; they are short.
+    char hint_buf[2][64];
+    if (rank == 0) {
+        hint_buf[0][params.cb_buffer_size.copy(hint_buf[0], 63)] = '\0';
+        hint_buf[1][params.romio_cb_read.copy(hint_buf[1], 63)] = '\0';
+    }
+    MPI_Bcast(hint_buf, 2 * 64, MPI_CHAR, 0, MPI_COMM_WORLD);
+    params.cb_buffer_size = std::string(hint_buf[0]);
+    params.romio_cb_read = std::string(hint_buf[1]);
 
     // Synchronize and start the timer.
     MPI_Barrier(MPI_COMM_WORLD);
@@ -69,112 +94,137 @@ int main(int argc, char* argv[]){
     }
 
     //--------
-    // Open the data file collectively using MPI I/O for each process
+    // Open the data file collectively using MPI I/O for each process, with the hints given on the command line
     //--------
+    MPI_Info hints;
+    MPI_Info_create(&hints);
+    if (!params.cb_buffer_size.empty())
+        MPI_Info_set(hints, "cb_buffer_size", params.cb_buffer_size.c_str());
+    if (!params.romio_cb_read.empty())
+        MPI_Info_set(hints, "romio_cb_read", params.romio_cb_read.c_str());
     MPI_File fh;            // file handle for mpi in parallel I/O
-    int ret = MPI_File_open(MPI_COMM_WORLD, params.file.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh);      // open the file
+    int ret = MPI_File_open(MPI_COMM_WORLD, params.file.c_str(), MPI_MODE_RDONLY, hints, &fh);      // open the file
     if (ret != MPI_SUCCESS) {       // error handling to check if the file is correctly opened  
         if (rank == 0)
             std::cerr << "Error opening file " << params.file << std::endl;
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
-    // Determine file size using MPI_File_get_size
-    MPI_Offset file_size;
-    MPI_File_get_size(fh, &file_size);
-    // Each record is 9 bytes long (8 characters + newline)
-    int total_records = file_size / 9;
-    // Broadcast total_records to ensure all processes have the same value
-    MPI_Bcast(&total_records, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    // The number of records follows from the file size (text) or the header (binary)
+    long long total_records = info.records;
 
     //--------
     // Compute the number of records for each process
     //--------
-    int records_per_proc = total_records / size;            // Get the number of records for each process
-    int remainder = total_records % size;                   // Remainder records
-    int my_records = records_per_proc + (rank < remainder ? 1 : 0);     // The record that is assigned to this process
+    long long records_per_proc = total_records / size;            // Get the number of records for each process
+    long long remainder = total_records % size;                   // Remainder records
+    long long my_records = records_per_proc + (rank < remainder ? 1 : 0);     // The record that is assigned to this process
     // Compute the starting record offset for this process.
-    int offset_records = (rank < remainder)             // if rank is less than remainder
+    long long offset_records = (rank < remainder)             // if rank is less than remainder
                            ? rank * (records_per_proc + 1)      // each process gets one more record
                            : remainder * (records_per_proc + 1) + (rank - remainder) * records_per_proc;        // otherwise the remaining records are distributed evenly
-    MPI_Offset offset_bytes = offset_records * 9; // each record is 9 bytes! 
-    // Allocate a buffer to read this process's portion of the file
-    rvector<char> buffer(my_records * 9);
-    MPI_File_read_at(fh, offset_bytes, buffer.data(), my_records * 9, MPI_CHAR, MPI_STATUS_IGNORE);
-    MPI_File_close(&fh);
 
     //--------
-    // Convert records to integers stoi(). Each record is 8 characters (ignore the newline).
-    //--------
-    rvector<int> local_data(my_records);
-    for (int i = 0; i < my_records; i++){
-        std::string record(buffer.data() + i * 9, 8);
-        try {
-            local_data[i] = std::stoi(record);
-        } catch (const std::invalid_argument &e) {
-            std::cerr << "Error: Cannot convert record '" << record 
-                      << "' at index " << i << " to integer." << std::endl;
-            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    // The range of the histogram: all step counts of 8 digits (text) or 32 bits (binary), or the range in the block table of a binary file
+    //--------
+    std::uint32_t range[2] = {1, info.binary ? std::numeric_limits<std::uint32_t>::max() : text_max_count};
+    if (info.nblocks > 0) {
+        if (rank == 0) {
+            rmatrix<std::uint32_t> blocks = read_block_table(params.file, info);
+            range[0] = blocks[0][0];
+            range[1] = blocks[0][1];
+            for (long long b = 1; b < info.nblocks; b++){
+                range[0] = std::min(range[0], blocks[b][0]);
+                range[1] = std::max(range[1], blocks[b][1]);
+            }
+            range[0] = std::max<std::uint32_t>(range[0], 1);    // a 0 is not binned
         }
+        MPI_Bcast(range, 2, MPI_UINT32_T, 0, MPI_COMM_WORLD);
     }
+    OrderHistogram histogram(params.base, range[0], range[1]);
+    bool use_sketch = params.sketch_k > 0;
+    QuantileSketch sketch(std::max(params.sketch_k, 8), rank);    // built in the same pass as the histogram
 
     //--------
-    // Each process computes the logarithm
+    // View the file as a sequence of records from the first one on: a text record is a contiguous type of 9 characters,
+    // a binary record a uint32. Offsets and counts of the reads are then in records.
     //--------
-    rvector<double> local_log(local_data.size());
-    for (size_t i = 0; i < local_data.size(); i++){
-        local_log[i] = std::log(local_data[i]) / std::log(params.base);
+    MPI_Datatype record_type = MPI_UINT32_T;
+    if (!info.binary) {
+        MPI_Type_contiguous(text_record_length, MPI_CHAR, &record_type);
+        MPI_Type_commit(&record_type);
+    }
+    MPI_File_set_view(fh, info.data_offset, record_type, record_type, "native", hints);
+    MPI_Info_free(&hints);
+    if (rank == 0) {
+        // Report the hints in effect, which the MPI library may have adjusted
+        MPI_Info used;
+        MPI_File_get_info(fh, &used);
+        for (const char* key : {"cb_buffer_size", "romio_cb_read"}) {
+            char value[MPI_MAX_INFO_VAL + 1];
+            int found = 0;
+            MPI_Info_get(used, key, MPI_MAX_INFO_VAL, value, &found);
+            std::cout << key << ": " << (found ? value : "(not supported)") << std::endl;
+        }
+        MPI_Info_free(&used);
     }
 
     //--------
-    // Compute local minimum and maximum of the log values same as the scatter workflow
-    //--------
-    double local_min = (local_log.size() > 0) ? local_log[0] : 0;
-    double local_max = (local_log.size() > 0) ? local_log[0] : 0;
-    for (size_t i = 0; i < local_log.size(); i++){
-        if (local_log[i] < local_min) local_min = local_log[i];
-        if (local_log[i] > local_max) local_max = local_log[i];
+    // Stream through this process's portion in chunks of batch_size records: read, convert and bin each chunk while it is in cache.
+    // The reads are collective, so every process takes part in every round, with an empty chunk once its portion is done.
+    //--------
+    long long max_records = records_per_proc + (remainder > 0 ? 1 : 0);                  // the largest portion
+    int chunk_size = static_cast<int>(std::min<long long>(params.batch_size, std::max(max_records, 1LL)));
+    long long num_rounds = (max_records + chunk_size - 1) / chunk_size;
+    rvector<std::uint32_t> steps(chunk_size);
+    rvector<char> text(info.binary ? 1 : static_cast<long long>(chunk_size) * text_record_length);
+    for (long long round = 0; round < num_rounds; round++){
+        long long first = round * chunk_size;
+        int n = static_cast<int>(std::max(0LL, std::min<long long>(chunk_size, my_records - first)));
+        MPI_Offset offset = offset_records + first;      // in records, relative to the view
+        if (info.binary) {
+            // Binary records are read straight into the step counts
+            MPI_File_read_at_all(fh, offset, steps.data(), n, record_type, MPI_STATUS_IGNORE);
+        } else {
+            MPI_File_read_at_all(fh, offset, text.data(), n, record_type, MPI_STATUS_IGNORE);
+            // Convert records to integers. Each record is 8 characters and a newline.
+            long long bad = parse_records(text.data(), n, steps.data());
+            if (bad >= 0) {
+                std::cerr << "Error: Cannot convert record '" << std::string(text.data() + bad * text_record_length, 8)
+                          << "' at index " << offset_records + first + bad << " to integer." << std::endl;
+                MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+            }
+        }
+        histogram.add(steps.data(), n);
+        if (use_sketch)
+            sketch.add(steps.data(), n);
     }
-    // Global reduction to determine the overall min and max.
-    double global_min, global_max;
-    MPI_Allreduce(&local_min, &global_min, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);         // Find the global minimum and maximum, broadcast to all processes
-    MPI_Allreduce(&local_max, &global_max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
-    
-    //--------
-    // Compute the histogram
-    //--------
-    int start_order = static_cast<int>(std::floor(global_min));
-    int end_order = static_cast<int>(std::floor(global_max));
-    int num_orders = end_order - start_order + 1;
-    int num_bins = num_orders;  // one bin per order
-    // Each process computes a local histogram.
-    rvector<double> local_hist(num_bins);       // Initialize local histogram
-    local_hist.fill(0);                         // Fill with zeros
-    for (size_t i = 0; i < local_log.size(); i++){      // Loop through local log values
-        double pos = local_log[i] - start_order;        // Calculate position in histogram
-        int bin = static_cast<int>(std::floor(pos));    // Determine bin index
-        if (bin >= 0 && bin < num_bins)                 // Check if bin index is valid
-            local_hist[bin] += 1;                       // Increment histogram bin
+    MPI_File_close(&fh);
+    if (!info.binary) {
+        MPI_Type_free(&record_type);
     }
-    
+    if (histogram.out_of_range() > 0) {
+        std::cerr << "Error: " << histogram.out_of_range() << " step counts are outside the range of the block table." << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    // Step counts of 0 have no logarithm; they are left out of the histogram and reported.
+    long long my_zeros = histogram.zeros();
+    long long total_zeros = 0;
+    MPI_Reduce(&my_zeros, &total_zeros, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
     //--------
-    // Reduce all local histograms to a global histogram to the root process
+    // Reduce the orders that occur on each process to a global histogram on the root process
     //--------
-    rvector<double> global_hist(num_bins);
-    global_hist.fill(0);
-    MPI_Reduce(local_hist.data(), global_hist.data(), num_bins, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    std::map<int, long long> global_hist = histogram.reduce(0, MPI_COMM_WORLD);
+    // Merge the quantile sketches of all processes on the root process
+    QuantileSketch global_sketch = use_sketch ? sketch.reduce(0, MPI_COMM_WORLD) : sketch;
     
     // Root process normalizes and prints the histogram and timing
     if (rank == 0) {
-        double total_count = 0;
-        for (int i = 0; i < num_bins; i++){
-            total_count += global_hist[i];
-        }
-        std::cout << "\nHistogram (log bin start, fraction):\n";
-        for (int i = 0; i < num_bins; i++){
-            double bin_log_start = start_order + i;
-            double fraction = global_hist[i] / total_count;
-            std::cout << bin_log_start << "    " << fraction << "\n";
-        }
+        if (total_zeros > 0)
+            std::cout << "\nLeft out " << total_zeros << " step counts of 0, which have no logarithm." << std::endl;
+        print_histogram(global_hist);
+        if (use_sketch)
+            print_quantiles(global_sketch);
         stopwatch.tock("\nTotal time:     ");
         std::cout << "\n" << std::string(30, '=') 
                   << "Calculation Complete" << std::string(30, '=') << "\n\n";
@@ -1,8 +1,11 @@
 ///@file mpi_hist_scatter.cpp
 ///@author Patrick Deng
 ///@date April 3, 2025
-///@brief This program reads a file containing integer records, computes the logarithm of each record, and generates a histogram of the log values using MPI for parallel processing.
+///@brief This program reads a file containing integer records, and generates a histogram of the logarithm of the records using MPI for parallel processing.
 /// The program is designed to be run in a distributed environment using MPI with scratter processing where the root process reads the file and distributes the data to other processes.
+/// The file can be text or in the packed binary format of stepfile.h, whose records the root reads without converting them.
+/// The root reads the next batch while the current one is scattered with MPI_Iscatterv, and the processes bin each batch as it arrives.
+/// With -parse workers, the root scatters the text records as they are in the file, and each process converts its own.
 
 #include <mpi.h>            /// MPI header file for mpi functions
 #include <iostream>         /// Standard I/O header file
@@ -11,9 +14,14 @@
 #include <string>
 #include <cstdlib>
 #include <algorithm>
-#include <filesystem>
+#include <cstdint>
+#include <limits>
 #include <rarray> 
 #include "init.h"
+#include "histogram.h"
+#include "quantile_sketch.h"
+#include "stepfile.h"
+#include "record_parser.h"
 #include "ticktock.h"
 
 
@@ -39,7 +47,7 @@ int main(int argc, char* argv[]){
         std::cout <<"\n"<< std::string(30, '=') << "Beginning Calculation" << std::string(30, '=')<<"\n\n";
         // Use the first process to parse command line arguments
         try {
-            params = parse_arguments(argc, argv);
+            params = parse_arguments(argc, argv, true);
         } catch (const std::runtime_error& e) {
             std::cerr << e.what() << std::endl;
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
@@ -49,6 +57,8 @@ int main(int argc, char* argv[]){
     // Broadcast base and batch_size.
     MPI_Bcast(&params.base, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
     MPI_Bcast(&params.batch_size, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&params.sketch_k, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&params.parse_on_workers, 1, MPI_INT, 0, MPI_COMM_WORLD);
     
     // Broadcast filename: first send its length, then the characters to all processes for subsequent receving
     int filename_length = 0;
@@ -65,167 +75,167 @@ int main(int argc, char* argv[]){
     if (rank != 0) {
         params.file = std::string(filename_buf);
     }
-    // Determine total_records (only rank 0 reads the file size)
-    int total_records = 0;
-    const int record_length = 9; // 8 characters per record + newline.
+    StepFileInfo info;
 
     //--------
-    // Using the root process to get the file size.
+    // Using the root process to get the format and the number of records.
     //--------
     if (rank == 0) {
         try {
-            auto file_size = std::filesystem::file_size(params.file);
-            total_records = static_cast<int>(file_size / record_length);
-        } catch(const std::filesystem::filesystem_error& e) {
-            std::cerr << "Filesystem error: " << e.what() << std::endl;
+            info = inspect_step_file(params.file);
+        } catch(const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
+        std::cout << "Format: " << (info.binary ? "binary" : "text") << std::endl;
+    }
+    // The layout of the file is plain data and is broadcast as bytes.
+    MPI_Bcast(&info, sizeof(info), MPI_BYTE, 0, MPI_COMM_WORLD);
+    long long total_records = info.records;
+    long long num_batches = (total_records + params.batch_size - 1) / params.batch_size;
+
+    //--------
+    // The range of the histogram: all step counts of 8 digits (text) or 32 bits (binary), or the range in the block table of a binary file
+    //--------
+    std::uint32_t range[2] = {1, info.binary ? std::numeric_limits<std::uint32_t>::max() : text_max_count};
+    if (info.nblocks > 0) {
+        if (rank == 0) {
+            rmatrix<std::uint32_t> blocks = read_block_table(params.file, info);
+            range[0] = blocks[0][0];
+            range[1] = blocks[0][1];
+            for (long long b = 1; b < info.nblocks; b++){
+                range[0] = std::min(range[0], blocks[b][0]);
+                range[1] = std::max(range[1], blocks[b][1]);
+            }
+            range[0] = std::max<std::uint32_t>(range[0], 1);    // a 0 is not binned
+        }
+        MPI_Bcast(range, 2, MPI_UINT32_T, 0, MPI_COMM_WORLD);
     }
-    MPI_Bcast(&total_records, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    // Preallocate the local_data array on each process knowing the final number of records
-    int my_total = total_records / size + (rank < (total_records % size) ? 1 : 0);
-    rvector<int> local_data(my_total);              // local data buffer
-    int local_offset = 0;                           // counter for storing received records
+    OrderHistogram histogram(params.base, range[0], range[1]);
+    bool use_sketch = params.sketch_k > 0;
+    QuantileSketch sketch(std::max(params.sketch_k, 8), rank);    // built in the same pass as the histogram
 
     //--------
-    // Main block for reading the file and distributing data
+    // Main block for reading the file and distributing data, pipelined with two buffers:
+    // while batch k is scattered with MPI_Iscatterv, the root reads batch k+1 and every process bins batch k-1.
+    // The send counts follow from the batch size, so every process computes them itself.
+    // Text records are either converted by the root and sent as integers, or sent as whole 9-byte records (a contiguous
+    // datatype, so the counts are in records either way) and converted by each process, which takes the conversion off the root.
     //--------
+    bool raw = params.parse_on_workers && !info.binary;       // binary records need no conversion anywhere
+    MPI_Datatype record_type = MPI_UINT32_T;
+    if (raw) {
+        MPI_Type_contiguous(text_record_length, MPI_CHAR, &record_type);
+        MPI_Type_commit(&record_type);
+    }
+    std::ifstream file;
     if (rank == 0) {
         // Root process reads the file and distributes the data.
-        std::ifstream file(params.file, std::ios::binary);
+        file.open(params.file, std::ios::binary);
         if (!file) {            // check if file opened successfully
             std::cerr << "Unable to open file " << params.file << std::endl;
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
-        int records_remaining = total_records;              // remaining records to read
-        while (records_remaining > 0) {
-            // Determine the number of records to read in this batch.
-            int current_batch = std::min(params.batch_size, records_remaining);
-            // Read current batch into a character buffer.
-            rvector<char> buffer(current_batch * record_length);
-            file.read(buffer.data(), current_batch * record_length);
-            // Convert records to integers.
-            rvector<int> batch_data(current_batch);
-            for (int i = 0; i < current_batch; i++){
-                std::string record(buffer.data() + i * record_length, 8);
-                try {
-                    batch_data[i] = std::stoi(record);
-                } catch (const std::invalid_argument &e) {
-                    std::cerr << "Error: Cannot convert record '" << record 
-                              << "' at index " << i << " to integer." << std::endl;
-                    MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
-                }
-            }
-            // Compute send counts for MPI_Scatterv.
-            rvector<int> send_counts(size);
+        file.seekg(info.data_offset);                       // skip the header and block table of a binary file
+    }
+    int max_batch = static_cast<int>(std::min<long long>(params.batch_size, std::max(total_records, 1LL)));
+    int max_share = max_batch / size + 1;                                   // records per process and batch
+    rvector<char> text((rank == 0 && !info.binary && !raw) ? static_cast<long long>(max_batch) * text_record_length : 1);
+    rmatrix<std::uint32_t> batch_data((rank == 0 && !raw) ? 2 : 1, max_batch);    // the two send buffers of the root
+    rmatrix<std::uint32_t> recv_buf(2, max_share);                          // the two receive buffers
+    rmatrix<char> raw_batch((rank == 0 && raw) ? 2 : 1, raw ? static_cast<long long>(max_batch) * text_record_length : 1);   // the same for unconverted records
+    rmatrix<char> raw_recv(raw ? 2 : 1, raw ? static_cast<long long>(max_share) * text_record_length : 1);
+    rmatrix<int> send_counts(2, size);
+    rmatrix<int> displs(2, size);
+    MPI_Request requests[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+    for (long long k = 0; k <= num_batches; k++){
+        int cur = k % 2;            // buffers of batch k
+        int prev = 1 - cur;         // buffers of batch k-1
+        if (k < num_batches) {
+            // Compute send counts and displacements for this batch.
+            int current_batch = static_cast<int>(std::min<long long>(params.batch_size, total_records - k * params.batch_size));
             int base_count = current_batch / size;
             int remainder = current_batch % size;
             for (int i = 0; i < size; i++){
-                send_counts[i] = base_count;
-                if (i < remainder) send_counts[i]++;
+                send_counts[cur][i] = base_count + (i < remainder ? 1 : 0);
+                displs[cur][i] = (i == 0) ? 0 : displs[cur][i-1] + send_counts[cur][i-1];
             }
-            // Compute displacements which is the offset for each process
-            rvector<int> displs(size);
-            displs[0] = 0;
-            for (int i = 1; i < size; i++){
-                displs[i] = displs[i-1] + send_counts[i-1];
-            }
-            // Broadcast current_batch and send_counts so non-root processes know how many to receive
-            MPI_Bcast(&current_batch, 1, MPI_INT, 0, MPI_COMM_WORLD);
-            MPI_Bcast(send_counts.data(), size, MPI_INT, 0, MPI_COMM_WORLD);
-            // Prepare receive buffer for this batch
-            rvector<int> recv_buf(send_counts[rank]);
-            MPI_Scatterv(batch_data.data(), send_counts.data(), displs.data(), MPI_INT,
-                         recv_buf.data(), send_counts[rank], MPI_INT, 0, MPI_COMM_WORLD);
-            // Copy the received numbers into local_data
-            for (int j = 0; j < send_counts[rank]; j++){
-                local_data[local_offset + j] = recv_buf[j];
+            void* send = nullptr;     // only the root has send buffers
+            if (rank == 0) {
+                // The scatter of batch k-2 from this buffer was completed in the previous round.
+                if (raw) {
+                    // The records are sent as they are.
+                    file.read(&raw_batch[cur][0], static_cast<std::streamsize>(current_batch) * text_record_length);
+                    send = &raw_batch[cur][0];
+                } else if (info.binary) {
+                    // Binary records are read straight into the batch.
+                    std::uint32_t* steps = &batch_data[cur][0];
+                    file.read(reinterpret_cast<char*>(steps), current_batch * sizeof(std::uint32_t));
+                    send = steps;
+                } else {
+                    // Read current batch into a character buffer and convert the records to integers.
+                    std::uint32_t* steps = &batch_data[cur][0];
+                    file.read(text.data(), static_cast<std::streamsize>(current_batch) * text_record_length);
+                    long long bad = parse_records(text.data(), current_batch, steps);
+                    if (bad >= 0) {
+                        std::cerr << "Error: Cannot convert record '" << std::string(text.data() + bad * text_record_length, 8)
+                                  << "' at index " << k * params.batch_size + bad << " to integer." << std::endl;
+                        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+                    }
+                    send = steps;
+                }
             }
-            local_offset += send_counts[rank];          // Sending the received data to the local data buffer
-            records_remaining -= current_batch;         // the number of records remaining to read 
+            void* recv = raw ? static_cast<void*>(&raw_recv[cur][0]) : static_cast<void*>(&recv_buf[cur][0]);
+            MPI_Iscatterv(send, &send_counts[cur][0], &displs[cur][0], record_type,
+                          recv, send_counts[cur][rank], record_type, 0, MPI_COMM_WORLD, &requests[cur]);
         }
-        file.close();
-    // The non-root process for receiving data
-    } else {
-        // Non-root processes receive data.
-        int records_received = 0;
-        // Process only if the number of records received is less than the total number of records.
-        while (records_received < total_records) {
-            int current_batch;
-            MPI_Bcast(&current_batch, 1, MPI_INT, 0, MPI_COMM_WORLD);               // broadcast current_batch to all processes
-            rvector<int> send_counts(size); 
-            MPI_Bcast(send_counts.data(), size, MPI_INT, 0, MPI_COMM_WORLD);        // broadcast send_counts to all processes
-            rvector<int> recv_buf(send_counts[rank]);           // buffer for receiving data
-            // MPI_Scatterv to receive the data.
-            MPI_Scatterv(nullptr, nullptr, nullptr, MPI_INT,
-                         recv_buf.data(), send_counts[rank], MPI_INT, 0, MPI_COMM_WORLD);
-            // Copy received data into local_data for the non-root process for further processing
-            for (int j = 0; j < send_counts[rank]; j++){
-                local_data[local_offset + j] = recv_buf[j];
+        if (k > 0) {
+            // Bin batch k-1 while batch k is on its way.
+            MPI_Wait(&requests[prev], MPI_STATUS_IGNORE);
+            if (raw) {
+                // Convert this process's records; its first record has index (k-1)*batch_size + displs in the file.
+                long long bad = parse_records(&raw_recv[prev][0], send_counts[prev][rank], &recv_buf[prev][0]);
+                if (bad >= 0) {
+                    std::cerr << "Error: Cannot convert record '" << std::string(&raw_recv[prev][0] + bad * text_record_length, 8)
+                              << "' at index " << (k - 1) * params.batch_size + displs[prev][rank] + bad
+                              << " to integer." << std::endl;
+                    MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+                }
             }
-            local_offset += send_counts[rank];
-            records_received += current_batch;
+            histogram.add(&recv_buf[prev][0], send_counts[prev][rank]);
+            if (use_sketch)
+                sketch.add(&recv_buf[prev][0], send_counts[prev][rank]);
         }
     }
-
-    //--------
-    // Each process computes the logarithm of its data.
-    //--------
-    rvector<double> local_log(local_data.size());
-    for (size_t i = 0; i < local_data.size(); i++){
-        local_log[i] = std::log(local_data[i]) / std::log(params.base);
+    if (rank == 0) {
+        file.close();
     }
-    // Compute local min and max for each process' data 
-    double local_min = (local_log.size() > 0) ? local_log[0] : 0;
-    double local_max = (local_log.size() > 0) ? local_log[0] : 0;
-    for (size_t i = 0; i < local_log.size(); i++){
-        if (local_log[i] < local_min) local_min = local_log[i];
-        if (local_log[i] > local_max) local_max = local_log[i];
+    if (raw) {
+        MPI_Type_free(&record_type);
     }
+    if (histogram.out_of_range() > 0) {
+        std::cerr << "Error: " << histogram.out_of_range() << " step counts are outside the range of the block table." << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    // Step counts of 0 have no logarithm; they are left out of the histogram and reported.
+    long long my_zeros = histogram.zeros();
+    long long total_zeros = 0;
+    MPI_Reduce(&my_zeros, &total_zeros, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
 
     //--------
-    // Compute global minimum and maximum
-    //--------
-    double global_min, global_max;
-    // Use MPI_Allreduce to find the global min and max across all processes, combining the results.
-    MPI_Allreduce(&local_min, &global_min, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
-    MPI_Allreduce(&local_max, &global_max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
-    
-    //--------
-    // Compute local histogram for each process
-    //--------
-    // Initialize  histogram parameters
-    int start_order = static_cast<int>(std::floor(global_min));
-    int end_order = static_cast<int>(std::floor(global_max));
-    int num_orders = end_order - start_order + 1;
-    double bin_width = 1.0;
-    int num_bins = num_orders;  // one bin per order
-    rvector<double> local_hist(num_bins);
-    local_hist.fill(0);
-    // Computing the histogram
-    for (size_t i = 0; i < local_log.size(); i++){
-        double pos = local_log[i] - start_order;
-        int bin = static_cast<int>(std::floor(pos));
-        if (bin >= 0 && bin < num_bins)
-            local_hist[bin] += 1;
-    }
     // Sum the local histograms into a global histogram on rank 0.
-    rvector<double> global_hist(num_bins);
-    global_hist.fill(0);
-    MPI_Reduce(local_hist.data(), global_hist.data(), num_bins, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    //--------
+    std::map<int, long long> global_hist = histogram.reduce(0, MPI_COMM_WORLD);
+    // Merge the quantile sketches into one on rank 0.
+    QuantileSketch global_sketch = use_sketch ? sketch.reduce(0, MPI_COMM_WORLD) : sketch;
     
     // Root normalizes and prints the histogram and the timing.
     if (rank == 0) {
-        double total_count = 0;
-        for (int i = 0; i < num_bins; i++){
-            total_count += global_hist[i];
-        }
-        std::cout << "\nHistogram (log bin start, fraction):\n";
-        for (int i = 0; i < num_bins; i++){
-            double bin_log_start = start_order + i;
-            double fraction = global_hist[i] / total_count;
-            std::cout << bin_log_start << "    " << fraction << "\n";
-        }
+        if (total_zeros > 0)
+            std::cout << "\nLeft out " << total_zeros << " step counts of 0, which have no logarithm." << std::endl;
+        print_histogram(global_hist);
+        if (use_sketch)
+            print_quantiles(global_sketch);
         // Stop the timer and print elapsed time
         stopwatch.tock("\nTotal time:     ");       // this combines the elapsed time measurement and output
         std::cout <<"\n"<< std::string(30, '=') << "Calculation Complete" << std::string(30, '=')<<"\n\n";
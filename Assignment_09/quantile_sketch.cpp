@@ -0,0 +1,305 @@
+///@file quantile_sketch.cpp
+///@author Patrick Deng
+///@date April 13, 2025
+///@brief This file contains the compaction, merging, reduction and output of the quantile sketch of the step counts.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include "quantile_sketch.h"
+
+QuantileSketch::QuantileSketch(int k, std::uint64_t seed)
+    : k_(k),
+      count_(0),
+      size_(0),
+      max_size_(0),
+      variance_(0),
+      random_state_(seed)
+{
+    grow();
+}
+
+// A new level on top. The capacities shrink by a factor 2/3 per level below the top, to no less than 2,
+// except that level 0 collects at least min_batch items. Any schedule of compactions is allowed, since
+// the error bound is computed from the compactions that were actually done.
+void QuantileSketch::grow() {
+    if (static_cast<int>(levels_.size()) == max_levels) {
+        throw std::length_error("Quantile sketch has run out of levels");
+    }
+    levels_.emplace_back();
+    int num_levels = levels_.size();
+    capacities_.resize(num_levels);
+    max_size_ = 0;
+    for (int h = 0; h < num_levels; h++){
+        int depth = num_levels - h - 1;
+        capacities_[h] = static_cast<int>(std::ceil(k_ * std::pow(2.0 / 3.0, depth))) + 1;
+        if (h == 0) {
+            capacities_[h] = std::max(capacities_[h], min_batch);
+        }
+        max_size_ += capacities_[h];
+    }
+}
+
+// splitmix64, small and good enough for a fair coin
+std::uint64_t QuantileSketch::random() {
+    std::uint64_t z = (random_state_ += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Level 0 is where every step count gets sorted once, so it is sorted by radix (four passes over the
+// bytes, without the branches of comparisons) unless it is small.
+void QuantileSketch::sort_level0() {
+    std::vector<std::uint32_t>& items = levels_[0];
+    std::size_t n = items.size();
+    if (n < 256) {
+        std::sort(items.begin(), items.end());
+        return;
+    }
+    std::size_t counts[4][256] = {};
+    for (std::uint32_t item : items){
+        counts[0][item & 255]++;
+        counts[1][(item >> 8) & 255]++;
+        counts[2][(item >> 16) & 255]++;
+        counts[3][item >> 24]++;
+    }
+    scratch_.resize(n);
+    std::uint32_t* from = items.data();
+    std::uint32_t* to = scratch_.data();
+    for (int pass = 0; pass < 4; pass++){
+        int shift = 8 * pass;
+        if (counts[pass][(from[0] >> shift) & 255] == n) {
+            continue;       // all items have the same byte here
+        }
+        std::size_t position = 0;
+        for (int digit = 0; digit < 256; digit++){
+            std::size_t count = counts[pass][digit];
+            counts[pass][digit] = position;
+            position += count;
+        }
+        for (std::size_t i = 0; i < n; i++){
+            to[counts[pass][(from[i] >> shift) & 255]++] = from[i];
+        }
+        std::swap(from, to);
+    }
+    if (from != items.data()) {
+        std::copy(from, from + n, items.data());
+    }
+}
+
+// Levels above 0 are kept sorted: sorted items are merged into them.
+void QuantileSketch::merge_into(int level, const std::uint32_t* sorted, std::size_t n) {
+    std::vector<std::uint32_t>& items = levels_[level];
+    scratch_.resize(items.size() + n);
+    std::merge(items.begin(), items.end(), sorted, sorted + n, scratch_.begin());
+    items.swap(scratch_);
+}
+
+// Move every second item of a level, from a random offset, one level up. An odd item out stays.
+void QuantileSketch::compact(int level) {
+    if (level + 1 == static_cast<int>(levels_.size())) {
+        grow();
+    }
+    if (level == 0) {
+        sort_level0();
+    }
+    std::vector<std::uint32_t>& items = levels_[level];
+    std::size_t pairs = items.size() / 2;
+    std::size_t offset = random() & 1;
+    promoted_.resize(pairs);
+    for (std::size_t i = 0; i < pairs; i++){
+        promoted_[i] = items[2 * i + offset];
+    }
+    merge_into(level + 1, promoted_.data(), pairs);
+    bool odd = items.size() % 2;
+    std::uint32_t last = items.back();
+    items.clear();
+    if (odd) {
+        items.push_back(last);
+    }
+    size_ -= pairs;
+    variance_ += std::ldexp(1.0, 2 * level);
+}
+
+// Compact the lowest full level until the sketch is below its capacity again.
+void QuantileSketch::compress() {
+    while (size_ >= max_size_) {
+        for (int h = 0; h < static_cast<int>(levels_.size()); h++){
+            if (static_cast<int>(levels_[h].size()) >= capacities_[h]) {
+                compact(h);
+                if (size_ < max_size_) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void QuantileSketch::add(const std::uint32_t* steps, long long n) {
+    for (long long i = 0; i < n; i++){
+        if (steps[i] == 0) {
+            continue;
+        }
+        levels_[0].push_back(steps[i]);
+        size_++;
+        count_++;
+        if (size_ >= max_size_) {
+            compress();
+        }
+    }
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    while (levels_.size() < other.levels_.size()) {
+        grow();
+    }
+    levels_[0].insert(levels_[0].end(), other.levels_[0].begin(), other.levels_[0].end());
+    for (std::size_t h = 1; h < other.levels_.size(); h++){
+        merge_into(h, other.levels_[h].data(), other.levels_[h].size());
+    }
+    count_ += other.count_;
+    size_ += other.size_;
+    variance_ += other.variance_;
+    // The same for either order of the two sketches, since the reduction is commutative
+    random_state_ += other.random_state_;
+    random();
+    compress();
+}
+
+std::vector<std::uint32_t> QuantileSketch::quantiles(const std::vector<double>& q) const {
+    std::vector<std::pair<std::uint32_t, long long>> weighted;
+    for (std::size_t h = 0; h < levels_.size(); h++){
+        for (std::uint32_t item : levels_[h]){
+            weighted.emplace_back(item, 1LL << h);
+        }
+    }
+    std::vector<std::uint32_t> result(q.size(), 0);
+    if (weighted.empty()) {
+        return result;
+    }
+    std::sort(weighted.begin(), weighted.end());
+    // The estimated rank of each kept item is the total weight up to and including it.
+    std::vector<long long> ranks(weighted.size());
+    long long rank = 0;
+    for (std::size_t i = 0; i < weighted.size(); i++){
+        rank += weighted[i].second;
+        ranks[i] = rank;
+    }
+    for (std::size_t j = 0; j < q.size(); j++){
+        double target = std::clamp(q[j], 0.0, 1.0) * count_;
+        std::size_t i = std::lower_bound(ranks.begin(), ranks.end(), target) - ranks.begin();
+        result[j] = weighted[std::min(i, weighted.size() - 1)].first;
+    }
+    return result;
+}
+
+// P(|error| >= t) <= 2 exp(-t^2 / (2 variance)), solved for t.
+double QuantileSketch::rank_error(double confidence) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    return std::sqrt(2 * variance_ * std::log(2 / (1 - confidence))) / count_;
+}
+
+// The header and room for the most items a sketch of capacity k keeps after compress(): the capacities
+// add up to less than k/(1 - 2/3) + 2 per level, plus min_batch for level 0.
+std::size_t QuantileSketch::serialized_bytes(int k) {
+    return sizeof(Header) + sizeof(std::uint32_t) * (3 * static_cast<std::size_t>(k) + 2 * max_levels + min_batch);
+}
+
+void QuantileSketch::serialize(char* buffer) const {
+    if (sizeof(Header) + size_ * sizeof(std::uint32_t) > serialized_bytes(k_)) {
+        throw std::length_error("Quantile sketch does not fit its serialized size");
+    }
+    Header header;
+    header.count = count_;
+    header.random_state = random_state_;
+    header.variance = variance_;
+    header.k = k_;
+    header.num_levels = levels_.size();
+    std::fill(header.level_size, header.level_size + max_levels, 0);
+    char* items = buffer + sizeof(Header);
+    for (std::size_t h = 0; h < levels_.size(); h++){
+        header.level_size[h] = levels_[h].size();
+        std::memcpy(items, levels_[h].data(), levels_[h].size() * sizeof(std::uint32_t));
+        items += levels_[h].size() * sizeof(std::uint32_t);
+    }
+    std::memcpy(buffer, &header, sizeof(Header));
+}
+
+QuantileSketch QuantileSketch::deserialize(const char* buffer) {
+    Header header;
+    std::memcpy(&header, buffer, sizeof(Header));
+    QuantileSketch sketch(header.k, header.random_state);
+    while (static_cast<int>(sketch.levels_.size()) < header.num_levels) {
+        sketch.grow();
+    }
+    const char* items = buffer + sizeof(Header);
+    for (int h = 0; h < header.num_levels; h++){
+        sketch.levels_[h].resize(header.level_size[h]);
+        std::memcpy(sketch.levels_[h].data(), items, header.level_size[h] * sizeof(std::uint32_t));
+        items += header.level_size[h] * sizeof(std::uint32_t);
+        sketch.size_ += header.level_size[h];
+    }
+    sketch.count_ = header.count;
+    sketch.variance_ = header.variance;
+    return sketch;
+}
+
+// The user function of the MPI_Op: merge each serialized sketch of in into the one of inout.
+void QuantileSketch::merge_op(void* in, void* inout, int* len, MPI_Datatype* type) {
+    int bytes;
+    MPI_Type_size(*type, &bytes);
+    for (int i = 0; i < *len; i++){
+        char* a = static_cast<char*>(in) + static_cast<std::size_t>(i) * bytes;
+        char* b = static_cast<char*>(inout) + static_cast<std::size_t>(i) * bytes;
+        QuantileSketch merged = deserialize(b);
+        merged.merge(deserialize(a));
+        merged.serialize(b);
+    }
+}
+
+QuantileSketch QuantileSketch::reduce(int root, MPI_Comm comm) const {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    std::size_t bytes = serialized_bytes(k_);
+    std::vector<char> local(bytes, 0);
+    std::vector<char> global(bytes, 0);
+    serialize(local.data());
+    MPI_Datatype sketch_type;
+    MPI_Type_contiguous(bytes, MPI_BYTE, &sketch_type);
+    MPI_Type_commit(&sketch_type);
+    MPI_Op merge;
+    MPI_Op_create(&QuantileSketch::merge_op, 1, &merge);
+    MPI_Reduce(local.data(), global.data(), 1, sketch_type, merge, root, comm);
+    MPI_Op_free(&merge);
+    MPI_Type_free(&sketch_type);
+    if (rank != root) {
+        return QuantileSketch(k_, 0);
+    }
+    return deserialize(global.data());
+}
+
+void print_quantiles(const QuantileSketch& sketch) {
+    const double confidence = 0.99;
+    double error = sketch.rank_error(confidence);
+    std::cout << "\nQuantiles (step count, range at " << confidence * 100 << "% confidence):\n";
+    const char* names[3] = {"p50", "p99", "p999"};
+    const double levels[3] = {0.5, 0.99, 0.999};
+    // Each quantile with the ones a rank error lower and higher
+    std::vector<double> q;
+    for (double level : levels){
+        q.insert(q.end(), {level, level - error, level + error});
+    }
+    std::vector<std::uint32_t> steps = sketch.quantiles(q);
+    for (int i = 0; i < 3; i++){
+        std::cout << names[i] << "    " << steps[3 * i]
+                  << "    [" << steps[3 * i + 1] << ", " << steps[3 * i + 2] << "]\n";
+    }
+    std::cout << "Rank error: " << error * 100 << "% of " << sketch.count() << " step counts, from "
+              << sketch.retained() << " kept" << std::endl;
+}
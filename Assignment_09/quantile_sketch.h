@@ -0,0 +1,105 @@
+/// @file quantile_sketch.h
+/// @brief Header file for the mergeable quantile sketch of the step counts.
+/// @author Patrick Deng
+/// @date April 13, 2025
+/// The sketch is a KLL sketch (Karnin, Lang and Liberty, 2016): a stack of compactors, where level h holds
+/// step counts that each stand for 2^h step counts. When the sketch is full, a level is sorted and every
+/// second item, starting at a random offset, is moved one level up with twice the weight; the others are
+/// dropped. The sketch keeps fewer than 3k + 2*levels + 1024 items however many step counts it has seen,
+/// so its memory grows only with the logarithm of the record count.
+///
+/// A compaction at level h changes the rank of any value by 0 or by +-2^h with equal probability, so the
+/// rank error is a sum of independent zero-mean terms. The sketch adds up the squared weights of its
+/// compactions, which bounds the error with the Azuma-Hoeffding inequality.
+///
+/// Sketches of different processes are merged level by level. For MPI the sketch is serialized into a
+/// fixed number of bytes, so that MPI_Reduce can merge the sketches of all processes with a custom MPI_Op.
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <mpi.h>
+#include <cstdint>
+#include <vector>
+
+/// @brief Approximate quantiles of the step counts, filled in chunks and mergeable across processes.
+class QuantileSketch {
+public:
+    /// @brief The largest number of levels, enough for 2^63 step counts.
+    static constexpr int max_levels = 64;
+
+    /// @brief The least capacity of level 0, so that the step counts are sorted in batches large enough for a radix sort.
+    static constexpr int min_batch = 1024;
+
+    /// @brief An empty sketch.
+    /// @param k The capacity of the top level, which sets the accuracy: the rank error shrinks as 1/k.
+    /// @param seed The seed of the random offsets of the compactions, different on each process.
+    QuantileSketch(int k, std::uint64_t seed);
+
+    /// @brief Adds step counts to the sketch; step counts of 0 are left out, as in the histogram.
+    /// @param steps The step counts.
+    /// @param n The number of step counts.
+    void add(const std::uint32_t* steps, long long n);
+
+    /// @brief The number of step counts added.
+    long long count() const { return count_; }
+
+    /// @brief The number of step counts kept in the sketch.
+    long long retained() const { return size_; }
+
+    /// @brief The step counts at several quantiles, from one sort of the kept items.
+    /// @param q The quantiles, between 0 and 1 (values outside are clamped).
+    /// @return For each quantile the smallest kept step count whose estimated rank is at least q*count() (0 for an empty sketch).
+    std::vector<std::uint32_t> quantiles(const std::vector<double>& q) const;
+
+    /// @brief A bound on the rank error of the quantiles, as a fraction of count().
+    /// @param confidence The probability that the error is within the bound, e.g. 0.99.
+    double rank_error(double confidence) const;
+
+    /// @brief Adds the step counts of another sketch, e.g. of another thread, with the same k.
+    /// @param other The sketch to add.
+    void merge(const QuantileSketch& other);
+
+    /// @brief The sketches of all processes, merged on the root.
+    /// @param root The rank that receives the merged sketch; the other ranks get an empty sketch.
+    /// @param comm The communicator.
+    QuantileSketch reduce(int root, MPI_Comm comm) const;
+
+private:
+    /// @brief Fixed-size part of the serialized sketch; the items of all levels follow it.
+    struct Header {
+        std::int64_t count;
+        std::uint64_t random_state;
+        double variance;
+        std::int32_t k;
+        std::int32_t num_levels;
+        std::uint32_t level_size[max_levels];
+    };
+
+    void grow();
+    void sort_level0();
+    void merge_into(int level, const std::uint32_t* sorted, std::size_t n);
+    void compact(int level);
+    void compress();
+    std::uint64_t random();
+    static std::size_t serialized_bytes(int k);
+    void serialize(char* buffer) const;
+    static QuantileSketch deserialize(const char* buffer);
+    static void merge_op(void* in, void* inout, int* len, MPI_Datatype* type);
+
+    int k_;                                          ///< capacity of the top level
+    long long count_;                                ///< step counts added
+    long long size_;                                 ///< items kept in all levels
+    long long max_size_;                             ///< sum of the capacities of the levels
+    double variance_;                                ///< sum of the squared weights of all compactions
+    std::uint64_t random_state_;                     ///< state of the generator of the compaction offsets
+    std::vector<std::vector<std::uint32_t>> levels_; ///< the compactors; items of level h have weight 2^h
+    std::vector<int> capacities_;                    ///< the number of items at which each level is compacted
+    std::vector<std::uint32_t> scratch_;             ///< work space of the sorting and merging, reused
+    std::vector<std::uint32_t> promoted_;            ///< the items moved up by a compaction, reused
+};
+
+/// @brief Prints the median, the 99th and the 99.9th percentile with their bounds at 99% confidence.
+/// @param sketch The merged sketch.
+void print_quantiles(const QuantileSketch& sketch);
+
+#endif
@@ -0,0 +1,25 @@
+///@file record_parser.cpp
+///@author Patrick Deng
+///@date April 9, 2025
+///@brief This file contains the conversion of blocks of text records to integers.
+
+#include "record_parser.h"
+#include "stepfile.h"
+
+// The validity of all records is combined without branches; only if one is invalid, the records are scanned again to find it.
+long long parse_records(const char* buffer, long long n, std::uint32_t* values) {
+    bool valid = true;
+    for (long long i = 0; i < n; i++){
+        valid &= parse_record(buffer + i * text_record_length, values[i]);
+    }
+    if (valid) {
+        return -1;
+    }
+    std::uint32_t value;
+    for (long long i = 0; i < n; i++){
+        if (!parse_record(buffer + i * text_record_length, value)) {
+            return i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,53 @@
+/// @file record_parser.h
+/// @brief Header file for converting the 9-byte text records of the step counts to integers.
+/// @author Patrick Deng
+/// @date April 9, 2025
+/// A text record is 8 characters, digits right-aligned with leading spaces, followed by a newline.
+/// Instead of std::stoi, which needs a std::string and handles locales, signs and exceptions, the
+/// 8 characters are loaded as one 64-bit word and checked and converted with a few integer operations
+/// on all 8 bytes at once ("SIMD within a register"), without branches.
+#ifndef RECORD_PARSER_H
+#define RECORD_PARSER_H
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "parse_record assumes a little-endian machine"
+#endif
+
+/// @brief Converts one text record to an integer.
+/// @param record Pointer to the 9 bytes of the record.
+/// @param value The step count, only meaningful if the record is valid.
+/// @return Whether the record is valid: at least one digit, only leading spaces, and a newline.
+inline bool parse_record(const char* record, std::uint32_t& value) {
+    const std::uint64_t ones = 0x0101010101010101ULL;
+    std::uint64_t word;
+    std::memcpy(&word, record, sizeof(word));   // the first character is the lowest byte
+    // Bytes that are not a digit: the high bit of (x & 0x7f) + 0x76 is set if x & 0x7f >= 10
+    std::uint64_t t = word ^ (ones * '0');
+    std::uint64_t nondigit = (((t & (ones * 0x7f)) + ones * 0x76) | t) & (ones * 0x80);
+    // Bytes that are a space: the same test for a non-zero byte, inverted
+    std::uint64_t s = word ^ (ones * ' ');
+    std::uint64_t space = ~(((s & (ones * 0x7f)) + ones * 0x7f) | s) & (ones * 0x80);
+    // The spaces have to be the lowest bytes, and not all of them
+    std::uint64_t leading = (space >> 7) * 0xff;
+    bool valid = ((nondigit & ~space) == 0) & ((leading & (leading + 1)) == 0)
+               & (leading != ~0ULL) & (record[8] == '\n');
+    // A space has 0 in its low four bits, just like '0'; combine digits pairwise into 2, 4 and 8 digits
+    word &= ones * 0x0f;
+    word = (word * 10 + (word >> 8)) & 0x00ff00ff00ff00ffULL;
+    word = (word * 100 + (word >> 16)) & 0x0000ffff0000ffffULL;
+    word = (word * 10000 + (word >> 32)) & 0x00000000ffffffffULL;
+    value = static_cast<std::uint32_t>(word);
+    return valid;
+}
+
+/// @brief Converts consecutive text records to integers.
+/// @param buffer The records, 9 bytes each.
+/// @param n The number of records.
+/// @param values Array of at least n step counts to fill.
+/// @return The index of the first invalid record, or -1 if all are valid.
+long long parse_records(const char* buffer, long long n, std::uint32_t* values);
+
+#endif
@@ -0,0 +1,64 @@
+///@file stepfile.cpp
+///@author Patrick Deng
+///@date April 8, 2025
+///@brief This file contains the functions to recognize the format of a step file and read the block table of the packed binary format.
+
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+#include "stepfile.h"
+
+// Determine the format from the magic string; text files start with a step count instead.
+StepFileInfo inspect_step_file(const std::string& filename) {
+    std::uintmax_t file_size;
+    try {
+        file_size = std::filesystem::file_size(filename);
+    } catch (const std::filesystem::filesystem_error& e) {
+        throw std::runtime_error(std::string("Filesystem error: ") + e.what());
+    }
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Unable to open file " + filename);
+    }
+    StepFileInfo info;
+    StepFileHeader header;
+    if (file_size >= sizeof(header)) {
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    }
+    if (file_size < sizeof(header) || !std::equal(step_magic, step_magic + 8, header.magic)) {
+        // text: 9-byte records, a trailing incomplete record is ignored
+        info.binary = false;
+        info.records = file_size / text_record_length;
+        info.record_bytes = text_record_length;
+        info.data_offset = 0;
+        info.block_size = 0;
+        info.nblocks = 0;
+        return info;
+    }
+    if (header.byte_order != step_byte_order) {
+        throw std::runtime_error("Step file " + filename + " was written with a different byte order");
+    }
+    info.binary = true;
+    info.records = header.records;
+    info.record_bytes = sizeof(std::uint32_t);
+    info.block_size = header.block_size;
+    info.nblocks = header.nblocks;
+    info.data_offset = sizeof(header) + 2 * sizeof(std::uint32_t) * static_cast<long long>(header.nblocks);
+    if (static_cast<long long>(file_size) < info.data_offset + info.records * info.record_bytes) {
+        throw std::runtime_error("Step file " + filename + " is truncated");
+    }
+    return info;
+}
+
+// The block table directly follows the header.
+rmatrix<std::uint32_t> read_block_table(const std::string& filename, const StepFileInfo& info) {
+    rmatrix<std::uint32_t> blocks(info.nblocks, 2);
+    std::ifstream file(filename, std::ios::binary);
+    file.seekg(sizeof(StepFileHeader));
+    file.read(reinterpret_cast<char*>(blocks.data()), blocks.size() * sizeof(std::uint32_t));
+    if (!file) {
+        throw std::runtime_error("Unable to read the block table of " + filename);
+    }
+    return blocks;
+}
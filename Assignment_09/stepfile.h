@@ -0,0 +1,82 @@
+/// @file stepfile.h
+/// @brief Header file for the two file formats of the walker step counts.
+/// @author Patrick Deng
+/// @date April 8, 2025
+/// The step counts come either as text, one 9-byte record per walker (8 characters and a
+/// newline), or in the packed binary format written by convert_steps:
+///
+///     offset 0                   header (StepFileHeader, 32 bytes)
+///     offset 32                  block table: for each block the minimum and maximum (2 x uint32)
+///     offset 32 + 8*nblocks      the step counts as packed uint32, in the order of the text file
+///
+/// The block table is optional (nblocks = 0). Numbers are stored in the byte order of the
+/// machine that wrote the file, which is checked through the magic string and a byte order mark.
+/// Both programs recognize the format from the first bytes of the file.
+#ifndef STEPFILE_H
+#define STEPFILE_H
+
+#include <cstdint>
+#include <string>
+#include <rarray>
+
+/// @brief Length of a text record: 8 characters plus a newline.
+const int text_record_length = 9;
+
+/// @brief The largest step count a text record of 8 digits can hold.
+const std::uint32_t text_max_count = 99999999;
+
+/// @brief Magic string at the start of a packed binary step file.
+const char step_magic[8] = {'S', 'T', 'E', 'P', 'B', 'I', 'N', '1'};
+
+/// @brief Byte order mark in the header, as written by the machine that made the file.
+const std::uint32_t step_byte_order = 0x01020304;
+
+/// @brief Header at the start of a packed binary step file.
+/// @param magic The magic string step_magic
+/// @param byte_order The byte order mark step_byte_order
+/// @param block_size Number of step counts per block of the block table (0 if there is none)
+/// @param records Number of step counts in the file
+/// @param nblocks Number of entries in the block table
+/// @param reserved Unused, zero
+struct StepFileHeader {
+    char magic[8];
+    std::uint32_t byte_order;
+    std::uint32_t block_size;
+    std::uint64_t records;
+    std::uint32_t nblocks;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(StepFileHeader) == 32, "the header of a step file must be 32 bytes");
+
+/// @brief Layout of a step file, the same for both formats so that readers need not tell them apart.
+/// @details This is plain data so that it can be broadcast with MPI_BYTE.
+/// @param binary Whether the file is in the packed binary format
+/// @param records Number of step counts in the file
+/// @param record_bytes Bytes per step count: 9 for text, 4 for binary
+/// @param data_offset Byte offset of the first step count
+/// @param block_size Step counts per block of the block table (binary files only)
+/// @param nblocks Number of entries in the block table (0 if there is none)
+struct StepFileInfo {
+    bool binary;
+    long long records;
+    int record_bytes;
+    long long data_offset;
+    int block_size;
+    long long nblocks;
+};
+
+/// @brief Determines the format and the layout of a step file from its size and first bytes.
+/// @param filename The name of the file.
+/// @return The layout of the file.
+/// @throws std::runtime_error if the file cannot be read, or is a binary file that is
+///         truncated or was written with a different byte order.
+StepFileInfo inspect_step_file(const std::string& filename);
+
+/// @brief Reads the block table of a binary step file.
+/// @param filename The name of the file.
+/// @param info The layout of the file, from inspect_step_file.
+/// @return An nblocks x 2 matrix with the minimum and maximum step count of each block.
+/// @throws std::runtime_error if the file cannot be read.
+rmatrix<std::uint32_t> read_block_table(const std::string& filename, const StepFileInfo& info);
+
+#endif
@@ -0,0 +1,21 @@
+#!/bin/bash
+#SBATCH --job-name=mpi_hist_hybrid
+#SBATCH --nodes=2
+#SBATCH --ntasks=80
+#SBATCH --time=00:10:00
+#SBATCH --output=log_mpi_hist_hybrid_%j.out
+
+module load gcc/13 openmpi/5 rarray
+module list
+
+base=1.1
+batch=100000
+filename="morestepnumbers_1.7GB.dat"
+
+# Run with 1, 2 and 4 processes per node, each with threads on the remaining cores:
+export OMP_NUM_THREADS=40
+mpirun -np 2 --map-by ppr:1:node:pe=40 ./mpi_hybrid -base $base -filename $filename -batch $batch
+export OMP_NUM_THREADS=20
+mpirun -np 4 --map-by ppr:2:node:pe=20 ./mpi_hybrid -base $base -filename $filename -batch $batch
+export OMP_NUM_THREADS=10
+mpirun -np 8 --map-by ppr:4:node:pe=10 ./mpi_hybrid -base $base -filename $filename -batch $batch
@@ -0,0 +1,385 @@
+/// @file amr.cpp
+/// @author Patrick Deng
+/// @date 2025-04-26
+/// @brief Two-level block-structured mesh refinement with subcycling in time.
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+/// See @ref amr.h
+#include "amr.h"
+#include "output.h"
+#include "fd_operators.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+AmrHierarchy::AmrHierarchy(const Param& p, MPI_Comm comm)
+  : N_(p.N),
+    r_(p.amrratio),
+    substeps_(p.amrratio*p.amrratio),
+    nc_((p.N-1)/p.amrratio + 1),
+    B_(p.amrblock),
+    A_(p.A),
+    dt_(p.D),
+    ratetol_(p.amrtol),
+    comm_(comm)
+{
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    left_  = (rank > 0) ? rank - 1 : MPI_PROC_NULL;
+    right_ = (rank < size-1) ? rank + 1 : MPI_PROC_NULL;
+    // whole layers of blocks go to each process, so the blocks do not depend on the number of processes
+    nb_  = (nc_-2 + B_-1)/B_;
+    bl0_ = (rank*nb_)/size;
+    bl1_ = ((rank+1)*nb_)/size;
+    if (bl1_ == bl0_) {
+        std::cerr << "Too many processes for the number of blocks\n";
+        MPI_Abort(comm, 1);
+    }
+    cstart_ = 1 + bl0_*B_;
+    cend_   = std::min(1 + bl1_*B_, nc_-1);
+    // coarse point c coincides with fine point r c and owns the fine points from r (c-1) + 1 to r c;
+    // the last process also owns the fine planes between its last coarse plane and the boundary
+    ffirst_ = r_*(cstart_-1) + 1;
+    fend_   = (cend_ == nc_-1) ? N_-1 : r_*(cend_-1) + 1;
+    dxf_    = p.L/(N_ - 1);
+    dxc_    = r_*dxf_;
+    alpha_  = dt_/(dxf_*dxf_);
+    // the front moves at speed 2 (in the units of the equation); one point more for the threshold
+    reach_  = int(std::ceil(2*p.amrregrid*substeps_*dt_/dxc_)) + 1;
+    if (reach_ > B_) {
+        std::cerr << "The front can cross more than one block between regrids; use a larger --amr-block or a smaller --amr-regrid\n";
+        MPI_Abort(comm, 1);
+    }
+    // Coarse level: zero inside, A on the boundaries
+    int Ni = cend_ - cstart_ + 2;
+    u_ = rtensor<double>(Ni, nc_, nc_);
+    u_.fill(A_);
+    for (int i = 1; i < Ni-1; i++)
+        for (int j = 1; j < nc_-1; j++)
+            for (int k = 1; k < nc_-1; k++)
+                u_[i][j][k] = 0.0;
+    uold_ = u_.copy();
+    index_ = rtensor<int>(bl1_-bl0_, nb_, nb_);
+    index_.fill(-1);
+    // planes that never arrive (at the domain boundary) stay marked as unrefined
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    sendlo_ = rmatrix<double>(N_, N_);
+    sendhi_ = rmatrix<double>(N_, N_);
+    recvlo_ = rmatrix<double>(N_, N_);
+    recvhi_ = rmatrix<double>(N_, N_);
+    recvlo_.fill(nan);
+    recvhi_.fill(nan);
+    exchange_coarse();
+    regrid();
+    // start the fine blocks from the exact initial state rather than from interpolation
+    for (FineBlock& blk : blocks_)
+        for (int i = 1; i < blk.u.extent(0)-1; i++)
+            for (int j = 1; j < blk.u.extent(1)-1; j++)
+                for (int k = 1; k < blk.u.extent(2)-1; k++)
+                    blk.u[i][j][k] = 0.0;
+}
+
+double AmrHierarchy::coarse_at(const rtensor<double>& c, int fi, int fj, int fk) const
+{
+    // fine indices that are multiples of r are coarse points, the others lie a fraction w of the way
+    // from coarse point f/r to the next
+    int i0 = fi/r_ - (cstart_-1), j0 = fj/r_, k0 = fk/r_;
+    double wi = double(fi%r_)/r_, wj = double(fj%r_)/r_, wk = double(fk%r_)/r_;
+    auto line = [&](int i, int j) {
+        return (wk == 0) ? c[i][j][k0] : (1-wk)*c[i][j][k0] + wk*c[i][j][k0+1];
+    };
+    auto plane = [&](int i) {
+        return (wj == 0) ? line(i, j0) : (1-wj)*line(i, j0) + wj*line(i, j0+1);
+    };
+    return (wi == 0) ? plane(i0) : (1-wi)*plane(i0) + wi*plane(i0+1);
+}
+
+AmrHierarchy::FineBlock AmrHierarchy::refine(int bi, int bj, int bk) const
+{
+    FineBlock blk;
+    blk.b[0] = bi;
+    blk.b[1] = bj;
+    blk.b[2] = bk;
+    int n[3];
+    for (int d = 0; d < 3; d++) {
+        int c0 = 1 + blk.b[d]*B_;
+        int c1 = std::min(c0 + B_, nc_-1);
+        int fe = (c1 == nc_-1) ? N_-1 : r_*(c1-1) + 1;
+        blk.f0[d] = r_*(c0-1);
+        n[d] = fe - blk.f0[d] + 1;
+    }
+    blk.u = rtensor<double>(n[0], n[1], n[2]);
+    for (int i = 0; i < n[0]; i++)
+        for (int j = 0; j < n[1]; j++)
+            for (int k = 0; k < n[2]; k++)
+                blk.u[i][j][k] = coarse_at(u_, blk.f0[0]+i, blk.f0[1]+j, blk.f0[2]+k);
+    blk.uold = blk.u.copy();
+    return blk;
+}
+
+void AmrHierarchy::regrid()
+{
+    int nl = bl1_ - bl0_;
+    int Ni = u_.extent(0);
+    // |du/dt| on the coarse level, from the right-hand side of the equation, which is large at the
+    // moving front and vanishes in the boundary layer that stays behind at the walls, and |grad u|
+    // (times 2 dx), which is large in both
+    rtensor<double> rate(Ni, nc_, nc_), grad(Ni, nc_, nc_);
+    double maxrate = 0.0, maxgrad = 0.0;
+    #pragma omp parallel for collapse(3) schedule(static) reduction(max:maxrate,maxgrad)
+    for (int i = 1; i < Ni-1; i++)
+        for (int j = 1; j < nc_-1; j++)
+            for (int k = 1; k < nc_-1; k++) {
+                double gx = u_[i+1][j][k] - u_[i-1][j][k];
+                double gy = u_[i][j+1][k] - u_[i][j-1][k];
+                double gz = u_[i][j][k+1] - u_[i][j][k-1];
+                rate[i][j][k] = std::fabs(fd::Laplacian<3, 2>::point(u_, i, j, k)/(dxc_*dxc_)
+                                          + u_[i][j][k]*(1-u_[i][j][k]));
+                grad[i][j][k] = std::sqrt(gx*gx + gy*gy + gz*gz);
+                maxrate = std::max(maxrate, rate[i][j][k]);
+                maxgrad = std::max(maxgrad, grad[i][j][k]);
+            }
+    double maxima[2] = {maxrate, maxgrad};
+    MPI_Allreduce(MPI_IN_PLACE, maxima, 2, MPI_DOUBLE, MPI_MAX, comm_);
+    // Relative to the largest values; the rate at least to the largest reaction rate 1/4, so that a
+    // solution that has settled is not refined.
+    double ratethreshold = ratetol_*std::max(maxima[0], 0.25);
+    double gradthreshold = ratetol_*maxima[1];
+    // For every block, the blocks that its moving points can reach before the next regrid:
+    // bit (di+1)*9+(dj+1)*3+(dk+1) is set if such a point lies within reach_ coarse points of
+    // the side of neighbour (di,dj,dk).  Bit 13, the block itself, is also set by steep points
+    // that do not move, which therefore refine only their own block.
+    rtensor<std::uint32_t> reach(nl+2, nb_, nb_);
+    reach.fill(0);
+    #pragma omp parallel for collapse(3) schedule(static)
+    for (int l = 0; l < nl; l++) {
+        for (int bj = 0; bj < nb_; bj++) {
+            for (int bk = 0; bk < nb_; bk++) {
+                int c0[3] = {1 + (bl0_+l)*B_, 1 + bj*B_, 1 + bk*B_};
+                int c1[3];
+                for (int d = 0; d < 3; d++)
+                    c1[d] = std::min(c0[d] + B_, nc_-1);
+                std::uint32_t bits = 0;
+                for (int ci = c0[0]; ci < c1[0]; ci++)
+                    for (int cj = c0[1]; cj < c1[1]; cj++)
+                        for (int ck = c0[2]; ck < c1[2]; ck++) {
+                            int i = ci-(cstart_-1);
+                            if (rate[i][cj][ck] <= ratethreshold) {
+                                if (grad[i][cj][ck] > gradthreshold)
+                                    bits |= 1u << 13;
+                                continue;
+                            }
+                            int c[3] = {ci, cj, ck};
+                            bool side[3][3];    // side[d][o+1]: the point reaches offset o in direction d
+                            for (int d = 0; d < 3; d++) {
+                                side[d][0] = c[d] - c0[d] < reach_;
+                                side[d][1] = true;
+                                side[d][2] = c1[d]-1 - c[d] < reach_;
+                            }
+                            for (int di = 0; di < 3; di++)
+                                for (int dj = 0; dj < 3; dj++)
+                                    for (int dk = 0; dk < 3; dk++)
+                                        if (side[0][di] && side[1][dj] && side[2][dk])
+                                            bits |= 1u << (di*9 + dj*3 + dk);
+                        }
+                reach[l+1][bj][bk] = bits;
+            }
+        }
+    }
+    int layer = nb_*nb_;
+    MPI_Sendrecv(&reach[1][0][0],    layer, MPI_UINT32_T, left_, 14,
+                 &reach[nl+1][0][0], layer, MPI_UINT32_T, right_,14,
+                 comm_, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(&reach[nl][0][0],   layer, MPI_UINT32_T, right_,14,
+                 &reach[0][0][0],    layer, MPI_UINT32_T, left_, 14,
+                 comm_, MPI_STATUS_IGNORE);
+    // refine every block that moving points can reach, so the front cannot escape before the
+    // next regrid, and the blocks with steep points; blocks that stay refined keep their fine values
+    std::vector<FineBlock> blocks;
+    rtensor<int> index(nl, nb_, nb_);
+    for (int l = 0; l < nl; l++) {
+        for (int bj = 0; bj < nb_; bj++) {
+            for (int bk = 0; bk < nb_; bk++) {
+                bool refined = false;
+                // the block at offset (di,dj,dk) from this one reaches it if it has bit (-di,-dj,-dk)
+                for (int di = -1; di <= 1; di++)
+                    for (int dj = std::max(-1, -bj); dj <= std::min(1, nb_-1-bj); dj++)
+                        for (int dk = std::max(-1, -bk); dk <= std::min(1, nb_-1-bk); dk++)
+                            refined = refined || ((reach[l+1+di][bj+dj][bk+dk] >> ((1-di)*9 + (1-dj)*3 + (1-dk))) & 1);
+                index[l][bj][bk] = refined ? int(blocks.size()) : -1;
+                if (!refined)
+                    continue;
+                if (index_[l][bj][bk] >= 0)
+                    blocks.push_back(std::move(blocks_[index_[l][bj][bk]]));
+                else
+                    blocks.push_back(refine(bl0_+l, bj, bk));
+            }
+        }
+    }
+    blocks_ = std::move(blocks);
+    index_ = index;
+}
+
+void AmrHierarchy::exchange_coarse()
+{
+    int Ni = u_.extent(0);
+    int planesize = nc_*nc_;
+    MPI_Sendrecv(&u_[1][0][0],    planesize, MPI_DOUBLE, left_, 11,
+                 &u_[Ni-1][0][0], planesize, MPI_DOUBLE, right_,11,
+                 comm_, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(&u_[Ni-2][0][0], planesize, MPI_DOUBLE, right_,11,
+                 &u_[0][0][0],    planesize, MPI_DOUBLE, left_, 11,
+                 comm_, MPI_STATUS_IGNORE);
+}
+
+void AmrHierarchy::exchange_fine_planes()
+{
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    sendlo_.fill(nan);
+    sendhi_.fill(nan);
+    for (const FineBlock& blk : blocks_) {
+        const rtensor<double>& a = blk.uold;
+        for (int j = 1; j < a.extent(1)-1; j++) {
+            for (int k = 1; k < a.extent(2)-1; k++) {
+                if (blk.b[0] == bl0_)
+                    sendlo_[blk.f0[1]+j][blk.f0[2]+k] = a[1][j][k];
+                if (blk.b[0] == bl1_-1)
+                    sendhi_[blk.f0[1]+j][blk.f0[2]+k] = a[a.extent(0)-2][j][k];
+            }
+        }
+    }
+    MPI_Sendrecv(&sendlo_[0][0], N_*N_, MPI_DOUBLE, left_, 13,
+                 &recvhi_[0][0], N_*N_, MPI_DOUBLE, right_,13,
+                 comm_, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(&sendhi_[0][0], N_*N_, MPI_DOUBLE, right_,13,
+                 &recvlo_[0][0], N_*N_, MPI_DOUBLE, left_, 13,
+                 comm_, MPI_STATUS_IGNORE);
+}
+
+void AmrHierarchy::fill_ghosts(int n, double theta)
+{
+    FineBlock& blk = blocks_[n];
+    rtensor<double>& a = blk.uold;
+    int ext[3] = {int(a.extent(0)), int(a.extent(1)), int(a.extent(2))};
+    for (int d = 0; d < 3; d++) {
+        int d1 = (d+1)%3;
+        int d2 = (d+2)%3;
+        for (int side = 0; side < 2; side++) {
+            // where do the values on this face come from?
+            int nbr[3] = {blk.b[0], blk.b[1], blk.b[2]};
+            nbr[d] += side ? 1 : -1;
+            bool boundary = nbr[d] < 0 || nbr[d] >= nb_;
+            const FineBlock* other = nullptr;
+            const rmatrix<double>* plane = nullptr;
+            if (!boundary) {
+                if (nbr[0] < bl0_)
+                    plane = &recvlo_;
+                else if (nbr[0] >= bl1_)
+                    plane = &recvhi_;
+                else if (index_[nbr[0]-bl0_][nbr[1]][nbr[2]] >= 0)
+                    other = &blocks_[index_[nbr[0]-bl0_][nbr[1]][nbr[2]]];
+            }
+            int q[3];
+            q[d] = side ? ext[d]-1 : 0;
+            for (q[d1] = 1; q[d1] < ext[d1]-1; q[d1]++) {
+                for (q[d2] = 1; q[d2] < ext[d2]-1; q[d2]++) {
+                    int fi = blk.f0[0]+q[0], fj = blk.f0[1]+q[1], fk = blk.f0[2]+q[2];
+                    double v;
+                    if (boundary)
+                        v = A_;
+                    else if (other)
+                        v = other->uold[fi-other->f0[0]][fj-other->f0[1]][fk-other->f0[2]];
+                    else if (plane && !std::isnan((*plane)[fj][fk]))
+                        v = (*plane)[fj][fk];
+                    else
+                        v = (1-theta)*coarse_at(uold_, fi, fj, fk) + theta*coarse_at(u_, fi, fj, fk);
+                    a[q[0]][q[1]][q[2]] = v;
+                }
+            }
+        }
+    }
+}
+
+void AmrHierarchy::step()
+{
+    // coarse step over the whole domain, covered parts included, since they serve the interpolation
+    std::swap(u_, uold_);
+    int Ni = u_.extent(0);
+    double dtc = substeps_*dt_;
+    #pragma omp parallel for collapse(3) schedule(static)
+    for (int i = 1; i < Ni-1; i++)
+        for (int j = 1; j < nc_-1; j++)
+            for (int k = 1; k < nc_-1; k++)
+                u_[i][j][k] = uold_[i][j][k] + alpha_*fd::Laplacian<3, 2>::point(uold_, i, j, k)
+                              + dtc*uold_[i][j][k]*(1-uold_[i][j][k]);
+    exchange_coarse();
+    // subcycle the fine blocks, with ghost values interpolated in time on coarse-fine faces
+    int nblocks = int(blocks_.size());
+    for (int sub = 0; sub < substeps_; sub++) {
+        for (FineBlock& blk : blocks_)
+            std::swap(blk.u, blk.uold);
+        exchange_fine_planes();
+        double theta = double(sub)/substeps_;
+        #pragma omp parallel for schedule(dynamic)
+        for (int n = 0; n < nblocks; n++) {
+            fill_ghosts(n, theta);
+            FineBlock& blk = blocks_[n];
+            rtensor<double>& u = blk.u;
+            const rtensor<double>& uold = blk.uold;
+            for (int i = 1; i < u.extent(0)-1; i++)
+                for (int j = 1; j < u.extent(1)-1; j++)
+                    for (int k = 1; k < u.extent(2)-1; k++)
+                        u[i][j][k] = uold[i][j][k] + alpha_*fd::Laplacian<3, 2>::point(uold, i, j, k)
+                                   + dt_*uold[i][j][k]*(1-uold[i][j][k]);
+        }
+    }
+    // the coarse points under a fine block take its values
+    #pragma omp parallel for schedule(dynamic)
+    for (int n = 0; n < nblocks; n++) {
+        const FineBlock& blk = blocks_[n];
+        int c0[3], c1[3];
+        for (int d = 0; d < 3; d++) {
+            c0[d] = 1 + blk.b[d]*B_;
+            c1[d] = std::min(c0[d] + B_, nc_-1);
+        }
+        for (int c = c0[0]; c < c1[0]; c++)
+            for (int cj = c0[1]; cj < c1[1]; cj++)
+                for (int ck = c0[2]; ck < c1[2]; ck++)
+                    u_[c-(cstart_-1)][cj][ck] = blk.u[r_*c-blk.f0[0]][r_*cj-blk.f0[1]][r_*ck-blk.f0[2]];
+    }
+    exchange_coarse();
+}
+
+void AmrHierarchy::snapshot(const std::string& fn, double t) const
+{
+    // the full resolution slab of this process, with a guard plane on each side as output() expects
+    int ni = fend_ - ffirst_;
+    rtensor<double> uf(ni+2, N_, N_);
+    #pragma omp parallel for collapse(2) schedule(static)
+    for (int a = 0; a < ni+2; a++)
+        for (int j = 0; j < N_; j++)
+            for (int k = 0; k < N_; k++)
+                uf[a][j][k] = coarse_at(u_, ffirst_-1+a, j, k);
+    for (const FineBlock& blk : blocks_)
+        for (int i = 1; i < blk.u.extent(0)-1; i++)
+            for (int j = 1; j < blk.u.extent(1)-1; j++)
+                for (int k = 1; k < blk.u.extent(2)-1; k++)
+                    uf[blk.f0[0]+i-(ffirst_-1)][blk.f0[1]+j][blk.f0[2]+k] = blk.u[i][j][k];
+    output(fn, t, dxf_, uf, comm_);
+}
+
+long AmrHierarchy::coarse_cells() const
+{
+    return long(cend_ - cstart_)*(nc_-2)*(nc_-2);
+}
+
+long AmrHierarchy::fine_cells() const
+{
+    long cells = 0;
+    for (const FineBlock& blk : blocks_)
+        cells += long(blk.u.extent(0)-2)*(blk.u.extent(1)-2)*(blk.u.extent(2)-2);
+    return cells;
+}
@@ -0,0 +1,126 @@
+/// @file amr.h
+///
+/// Two-level block-structured adaptive mesh refinement for the 3D
+/// KPP-Fisher equation.
+///
+/// The base level is a coarse grid whose spacing is r times that of the
+/// requested N (N-1 must be a multiple of r, so that every r-th fine point
+/// is a coarse point).  Its interior is divided into cubic blocks of B coarse
+/// points, and the layers of blocks along i are distributed over the MPI
+/// processes.  Blocks where the coarse |du/dt| exceeds a fraction of its
+/// maximum, i.e. the front, are covered by a fine block at the full
+/// resolution, as are the neighbours the front can reach before the blocks
+/// are regridded, every R coarse steps.  Where |grad u| exceeds the same
+/// fraction of its maximum but u hardly changes, as in the boundary layer
+/// at the walls, only the block itself is refined.
+///
+/// One coarse step of r^2 dt is followed by r^2 fine steps of dt on every
+/// fine block (subcycling; both levels then have the same D dt/dx^2).  The face
+/// ghost points of a fine block come from the neighbouring fine block if
+/// it exists, also on a neighbouring process, or else from trilinear
+/// interpolation of the coarse level, linear in time between the start and
+/// end of the coarse step.  Afterwards the fine values are injected into
+/// the coarse points they cover.  Fine blocks are updated in parallel with
+/// OpenMP.
+///
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+///
+#ifndef AMRH
+#define AMRH
+
+#include <mpi.h>
+#include <rarray>
+#include <string>
+#include <vector>
+#include "params.h"
+
+///
+/// @brief The coarse level and the fine blocks of one process
+///
+class AmrHierarchy
+{
+  public:
+    ///
+    /// @brief Set up the initial state and refine around it
+    ///
+    /// @param p    the parameters; see @ref params.h (Param)
+    /// @param comm the communicator of the processes sharing the work
+    ///
+    AmrHierarchy(const Param& p, MPI_Comm comm);
+
+    /// @brief Advance both levels by one coarse time step (r^2 fine steps)
+    void step();
+
+    /// @brief Choose the fine blocks anew from the rate of change and gradient of the coarse level
+    void regrid();
+
+    ///
+    /// @brief Write the composite solution at the full resolution
+    ///
+    /// Fine values are used where blocks are refined, interpolated coarse
+    /// values elsewhere; the file format is that of output().
+    ///
+    /// @param fn the name of the file to write to
+    /// @param t  the current time
+    ///
+    void snapshot(const std::string& fn, double t) const;
+
+    /// @brief Number of coarse interior points on this process
+    long coarse_cells() const;
+
+    /// @brief Number of fine interior points on this process
+    long fine_cells() const;
+
+    /// @brief Number of fine blocks on this process
+    long fine_blocks() const { return long(blocks_.size()); }
+
+  private:
+    /// A refined block, with one layer of ghost points around it
+    struct FineBlock {
+        int b[3];                ///< global block index in each direction
+        int f0[3];               ///< global fine index of the first (ghost) point in each direction
+        rtensor<double> u;       ///< fine values at the current time
+        rtensor<double> uold;    ///< fine values at the previous fine step
+    };
+
+    /// create the fine block with global block index (bi,bj,bk), interpolated from the coarse level
+    FineBlock refine(int bi, int bj, int bk) const;
+
+    /// trilinear interpolation of the coarse field c at the global fine point (fi,fj,fk)
+    double coarse_at(const rtensor<double>& c, int fi, int fj, int fk) const;
+
+    /// fill the face ghost points of the uold of block n at fraction theta of the coarse step
+    void fill_ghosts(int n, double theta);
+
+    /// exchange the fine values of the outermost owned planes with the neighbouring processes
+    void exchange_fine_planes();
+
+    /// exchange the guard planes of the coarse field u
+    void exchange_coarse();
+
+    int N_;                          ///< fine points per direction
+    int r_;                          ///< refinement ratio
+    int substeps_;                   ///< fine steps per coarse step, r^2
+    int nc_;                         ///< coarse points per direction
+    int B_;                          ///< coarse points per block edge
+    int nb_;                         ///< blocks per direction
+    int bl0_, bl1_;                  ///< range of block layers in i owned by this process
+    int cstart_, cend_;              ///< range of global coarse interior planes owned by this process
+    int ffirst_, fend_;              ///< range of global fine interior planes owned by this process
+    double A_;                       ///< boundary value
+    double dt_;                      ///< fine time step (the coarse one is r^2 times longer)
+    double alpha_;                   ///< D dt/dx^2, equal on both levels
+    double dxc_;                     ///< coarse grid spacing
+    double dxf_;                     ///< fine grid spacing
+    double ratetol_;                 ///< refine where the coarse |du/dt| or |grad u| exceeds this fraction of its maximum
+    int reach_;                      ///< coarse points the front may move between regrids
+    int left_, right_;               ///< neighbouring processes (or MPI_PROC_NULL)
+    MPI_Comm comm_;
+    rtensor<double> u_, uold_;       ///< coarse level, with guard planes in i
+    std::vector<FineBlock> blocks_;  ///< the fine blocks of this process
+    rtensor<int> index_;             ///< position in blocks_ of each local block, or -1
+    rmatrix<double> sendlo_, sendhi_;///< our first and last fine plane (NaN where unrefined)
+    rmatrix<double> recvlo_, recvhi_;///< the neighbours' adjacent fine planes
+};
+
+#endif
@@ -0,0 +1,159 @@
+/// @file autotune.cpp
+/// @author Patrick Deng
+/// @date 2025-04-20
+/// @brief Timed probes over threads-per-rank layouts for the hybrid solver, with a per (N, node type) cache.
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+/// See @ref autotune.h
+#include "autotune.h"
+#include <omp.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <limits>
+#include <cctype>
+#include <thread>
+#include <chrono>
+
+/// @brief describe the node as its host name without trailing digits and its number of cores
+static std::string node_type(int cores_per_node)
+{
+    char name[MPI_MAX_PROCESSOR_NAME];
+    int len;
+    MPI_Get_processor_name(name, &len);
+    std::string host(name, len);
+    host = host.substr(0, host.find('.'));
+    while (!host.empty() && std::isdigit(static_cast<unsigned char>(host.back())))
+        host.pop_back();
+    return host + "x" + std::to_string(cores_per_node);
+}
+
+/// @brief look up the tuned threads per rank for (N, type) in the cache file; 0 if absent
+static int read_cache(int N, const std::string& type)
+{
+    std::ifstream in(autotune_cache);
+    std::string line;
+    int threads = 0;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        int cachedN, cachedthreads;
+        std::string cachedtype;
+        if (fields >> cachedN >> cachedtype >> cachedthreads && cachedN == N && cachedtype == type)
+            threads = cachedthreads;  // the last entry wins
+    }
+    return threads;
+}
+
+/// @brief append the tuned threads per rank for (N, type) to the cache file
+static void write_cache(int N, const std::string& type, int threads)
+{
+    std::ofstream out(autotune_cache, std::ios::app);
+    out << N << " " << type << " " << threads << "\n";
+}
+
+/// @brief whether nprocs processes can share the system: the test of the solver on the thinnest
+/// slab, which needs 2*depth-1 planes next to guard planes depth deep (depth 2 for order 4)
+static bool fits(const Param& p, int nprocs)
+{
+    int depth = p.order/2;
+    return (p.N - 2)/nprocs >= 2*depth - 1;
+}
+
+/// @brief the number of ranks that remain active when merging m ranks per node
+static int count_active(MPI_Comm comm, MPI_Comm node, int m)
+{
+    int noderank, nactive;
+    MPI_Comm_rank(node, &noderank);
+    int active = (noderank % m == 0);
+    MPI_Allreduce(&active, &nactive, 1, MPI_INT, MPI_SUM, comm);
+    return nactive;
+}
+
+/// @brief split off the ranks that remain active when merging m ranks per node; MPI_COMM_NULL on the others
+static MPI_Comm active_ranks(MPI_Comm comm, MPI_Comm node, int m)
+{
+    int rank, noderank;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_rank(node, &noderank);
+    MPI_Comm sub;
+    MPI_Comm_split(comm, (noderank % m == 0) ? 0 : MPI_UNDEFINED, rank, &sub);
+    return sub;
+}
+
+void relaxed_barrier(MPI_Comm comm)
+{
+    MPI_Request request;
+    int done = 0;
+    MPI_Ibarrier(comm, &request);
+    MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+    while (!done) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+    }
+}
+
+MPI_Comm autotune(const Param& p, MPI_Comm comm, probe_function probe)
+{
+    int rank, size, nodesize, minnodesize;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    MPI_Comm node;                  // the ranks sharing this node
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node);
+    MPI_Comm_size(node, &nodesize);
+    MPI_Allreduce(&nodesize, &minnodesize, 1, MPI_INT, MPI_MIN, comm);
+    // threads each rank was launched with; merging m ranks gives m times as many
+    int base = omp_get_max_threads();
+    std::string type = node_type(nodesize * base);
+
+    // Reuse an earlier choice for this problem size and node type if it fits this allocation
+    int best = 0;
+    if (rank == 0)
+        best = read_cache(p.N, type);
+    MPI_Bcast(&best, 1, MPI_INT, 0, comm);
+    if (best > 0 && (best % base != 0 || minnodesize % (best / base) != 0))
+        best = 0;
+    if (best > 0 && !fits(p, count_active(comm, node, best / base)))   // e.g. tuned for order 2
+        best = 0;
+    if (rank == 0 && best > 0)
+        std::cout << "#autotune cached " << best << " threads per rank\n";
+
+    // Otherwise, time a short run for every way of merging ranks on a node
+    if (best == 0) {
+        double besttime = std::numeric_limits<double>::max();
+        for (int m = 1; m <= minnodesize; m++) {
+            if (minnodesize % m != 0)
+                continue;
+            int nactive = count_active(comm, node, m);
+            if (!fits(p, nactive))  // too many processes for the size of the system
+                continue;
+            MPI_Comm sub = active_ranks(comm, node, m);
+            double elapsed = 0.0, slowest;
+            if (sub != MPI_COMM_NULL) {
+                omp_set_num_threads(m * base);
+                elapsed = probe(p, sub, p.autotune);
+                MPI_Comm_free(&sub);
+            }
+            relaxed_barrier(comm);
+            MPI_Allreduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, comm);
+            if (rank == 0)
+                std::cout << "#autotune " << nactive << " ranks x " << m * base
+                          << " threads: " << slowest << " s\n";
+            if (slowest < besttime) {
+                besttime = slowest;
+                best = m * base;
+            }
+        }
+        if (best == 0)              // no layout fits; keep all ranks and let the solver report it
+            best = base;
+        else if (rank == 0) {
+            std::cout << "#autotune selected " << best << " threads per rank\n";
+            write_cache(p.N, type, best);
+        }
+    }
+
+    // Set up the chosen layout; idle ranks keep a single thread
+    MPI_Comm sub = active_ranks(comm, node, best / base);
+    omp_set_num_threads(sub != MPI_COMM_NULL ? best : 1);
+    MPI_Comm_free(&node);
+    return sub;
+}
@@ -0,0 +1,52 @@
+/// @file autotune.h
+///
+/// Self-tuning selection of the number of OpenMP threads per MPI rank
+/// for the hybrid solver.
+///
+/// The job is launched with one rank per core group (e.g. 40 ranks per
+/// node with OMP_NUM_THREADS=1).  The autotuner then tries merging m
+/// ranks on a node into one active rank running m times as many
+/// threads, times a short probe run for each m, and keeps the fastest.
+/// The merged-away ranks sit idle for the rest of the run.  The choice
+/// is cached per (N, node type) so later runs skip the probes.
+///
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+///
+#ifndef AUTOTUNEH
+#define AUTOTUNEH
+
+#include <mpi.h>
+#include "params.h"
+
+/// File in the working directory holding previously tuned layouts
+const char* const autotune_cache = "pkkfisher3d_autotune.cache";
+
+/// Signature of a probe run: simulate a few steps on comm without output, returning the elapsed time
+typedef double (*probe_function)(const Param& p, MPI_Comm comm, int probe_steps);
+
+///
+/// @brief Choose the fastest threads-per-rank layout for this allocation
+///
+/// Sets the number of OpenMP threads on every rank of comm, and returns
+/// the communicator of the ranks that should run the simulation, or
+/// MPI_COMM_NULL on ranks that should stay idle.  Collective over comm.
+///
+/// @param p     the parameters (p.autotune gives the steps per probe)
+/// @param comm  communicator of all ranks in the allocation
+/// @param probe function that runs and times a short simulation
+///
+/// @returns communicator of the active ranks, or MPI_COMM_NULL
+///
+MPI_Comm autotune(const Param& p, MPI_Comm comm, probe_function probe);
+
+///
+/// @brief Barrier that polls with sleeps instead of spinning
+///
+/// Used so that idle ranks do not compete for cores with the threads
+/// of the active ranks.  Collective over comm.
+///
+/// @param comm the communicator to synchronize
+///
+void relaxed_barrier(MPI_Comm comm);
+
+#endif
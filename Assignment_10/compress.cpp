@@ -0,0 +1,169 @@
+/// @file compress.cpp
+/// @author Patrick Deng
+/// @date 2025-04-27
+/// @brief Byte-plane shuffling, LZ77 coding and error-bounded quantization of doubles.
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+/// See @ref compress.h
+#include "compress.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/// shortest match worth coding
+static const std::size_t minmatch = 4;
+
+/// @brief append x to out as an LEB128 variable-length integer
+static void put_varint(std::vector<char>& out, std::uint64_t x)
+{
+    while (x >= 0x80) {
+        out.push_back(char((x & 0x7f) | 0x80));
+        x >>= 7;
+    }
+    out.push_back(char(x));
+}
+
+/// @brief read a variable-length integer at in[pos], advancing pos; false if it runs past size
+static bool get_varint(const char* in, std::size_t size, std::size_t& pos, std::uint64_t& x)
+{
+    x = 0;
+    for (int shift = 0; shift < 64 && pos < size; shift += 7) {
+        unsigned char c = in[pos++];
+        x |= std::uint64_t(c & 0x7f) << shift;
+        if (!(c & 0x80))
+            return true;
+    }
+    return false;
+}
+
+/// @brief hash of the four bytes at p, for finding earlier occurrences
+static std::uint32_t hash4(const unsigned char* p)
+{
+    std::uint32_t x;
+    std::memcpy(&x, p, 4);
+    return (x*2654435761u) >> 16;
+}
+
+///
+/// @brief LZ77 coding: a sequence of (literal count, literals, match length, match offset),
+/// ending with a literal run without a match
+///
+static std::vector<char> lz_compress(const std::vector<unsigned char>& src)
+{
+    std::vector<char> out;
+    out.reserve(src.size()/4 + 16);
+    std::vector<std::int64_t> last(1<<16, -1);
+    std::size_t n = src.size();
+    std::size_t anchor = 0;
+    std::size_t i = 0;
+    while (i + minmatch <= n) {
+        std::uint32_t h = hash4(&src[i]);
+        std::int64_t cand = last[h];
+        last[h] = i;
+        if (cand >= 0 && std::memcmp(&src[cand], &src[i], minmatch) == 0) {
+            std::size_t len = minmatch;
+            while (i + len < n && src[cand + len] == src[i + len])
+                len++;
+            put_varint(out, i - anchor);
+            out.insert(out.end(), src.begin() + anchor, src.begin() + i);
+            put_varint(out, len);
+            put_varint(out, i - cand);
+            i += len;
+            anchor = i;
+        } else {
+            i++;
+        }
+    }
+    put_varint(out, n - anchor);
+    out.insert(out.end(), src.begin() + anchor, src.end());
+    put_varint(out, 0);
+    return out;
+}
+
+/// @brief inverse of lz_compress; false if the input is corrupt or does not give n bytes
+static bool lz_decompress(const char* in, std::size_t size, std::vector<unsigned char>& dst, std::size_t n)
+{
+    dst.clear();
+    dst.reserve(n);
+    std::size_t pos = 0;
+    while (true) {
+        std::uint64_t lit, len, off;
+        if (!get_varint(in, size, pos, lit) || lit > size - pos || dst.size() + lit > n)
+            return false;
+        dst.insert(dst.end(), in + pos, in + pos + lit);
+        pos += lit;
+        if (!get_varint(in, size, pos, len))
+            return false;
+        if (len == 0)
+            break;
+        if (!get_varint(in, size, pos, off) || off == 0 || off > dst.size() || dst.size() + len > n)
+            return false;
+        // byte by byte, since a match may overlap the bytes it produces
+        std::size_t from = dst.size() - off;
+        for (std::uint64_t m = 0; m < len; m++)
+            dst.push_back(dst[from + m]);
+    }
+    return pos == size && dst.size() == n;
+}
+
+std::vector<char> compress_values(const double* v, std::size_t n, int mode, double tol)
+{
+    std::vector<unsigned char> bytes;
+    if (mode == COMPRESS_LOSSY) {
+        // quantized differences from the previous reconstructed value, zigzag-coded as varints
+        double step = 2*tol;
+        double prev = 0.0;
+        std::vector<char> q;
+        q.reserve(n);
+        for (std::size_t m = 0; m < n; m++) {
+            std::int64_t d = std::llround((v[m] - prev)/step);
+            put_varint(q, (std::uint64_t(d) << 1) ^ std::uint64_t(d >> 63));
+            prev += d*step;
+        }
+        bytes.assign(q.begin(), q.end());
+    } else {
+        // byte plane b holds byte b of every value
+        bytes.resize(n*sizeof(double));
+        const unsigned char* raw = reinterpret_cast<const unsigned char*>(v);
+        for (std::size_t b = 0; b < sizeof(double); b++)
+            for (std::size_t m = 0; m < n; m++)
+                bytes[b*n + m] = raw[m*sizeof(double) + b];
+    }
+    std::vector<char> out;
+    put_varint(out, bytes.size());
+    std::vector<char> coded = lz_compress(bytes);
+    out.insert(out.end(), coded.begin(), coded.end());
+    return out;
+}
+
+bool decompress_values(const char* in, std::size_t size, double* v, std::size_t n, int mode, double tol)
+{
+    std::size_t pos = 0;
+    std::uint64_t nbytes;
+    if (!get_varint(in, size, pos, nbytes) || nbytes > 10*n + sizeof(double)*n)
+        return false;
+    std::vector<unsigned char> bytes;
+    if (!lz_decompress(in + pos, size - pos, bytes, nbytes))
+        return false;
+    if (mode == COMPRESS_LOSSY) {
+        double step = 2*tol;
+        double prev = 0.0;
+        const char* q = reinterpret_cast<const char*>(bytes.data());
+        std::size_t qpos = 0;
+        for (std::size_t m = 0; m < n; m++) {
+            std::uint64_t z;
+            if (!get_varint(q, bytes.size(), qpos, z))
+                return false;
+            std::int64_t d = std::int64_t(z >> 1) ^ -std::int64_t(z & 1);
+            prev += d*step;
+            v[m] = prev;
+        }
+        return qpos == bytes.size();
+    }
+    if (bytes.size() != n*sizeof(double))
+        return false;
+    unsigned char* raw = reinterpret_cast<unsigned char*>(v);
+    for (std::size_t b = 0; b < sizeof(double); b++)
+        for (std::size_t m = 0; m < n; m++)
+            raw[m*sizeof(double) + b] = bytes[b*n + m];
+    return true;
+}
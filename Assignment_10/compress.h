@@ -0,0 +1,54 @@
+/// @file compress.h
+///
+/// Compression of blocks of doubles for the compressed snapshot files.
+///
+/// Two modes are available:
+/// - lossless: the bytes of the values are regrouped into byte planes
+///   (all first bytes, then all second bytes, ...), which turns the
+///   mostly equal sign, exponent and leading mantissa bytes of a smooth
+///   field into long runs, and the result is coded with a simple LZ77
+///   scheme.
+/// - lossy: every value is predicted by the previous reconstructed value,
+///   and the difference is quantized in steps of 2 tol, so each value is
+///   reproduced to within tol (up to rounding).  The quantized differences
+///   are small integers which are stored as variable-length integers and
+///   then LZ77-coded as well.
+///
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+///
+#ifndef COMPRESSH
+#define COMPRESSH
+
+#include <cstddef>
+#include <vector>
+
+/// Compression modes, as stored in the snapshot headers
+enum CompressionMode { COMPRESS_NONE = 0, COMPRESS_LOSSLESS = 1, COMPRESS_LOSSY = 2 };
+
+///
+/// @brief Compress n values
+///
+/// @param v    the values
+/// @param n    number of values
+/// @param mode COMPRESS_LOSSLESS or COMPRESS_LOSSY
+/// @param tol  absolute error bound for COMPRESS_LOSSY
+///
+/// @returns the compressed bytes
+///
+std::vector<char> compress_values(const double* v, std::size_t n, int mode, double tol);
+
+///
+/// @brief Decompress n values produced by compress_values
+///
+/// @param in   the compressed bytes
+/// @param size number of compressed bytes
+/// @param v    where to store the values
+/// @param n    number of values
+/// @param mode the mode used for compression
+/// @param tol  the tolerance used for compression
+///
+/// @returns false if the compressed data is corrupt
+///
+bool decompress_values(const char* in, std::size_t size, double* v, std::size_t n, int mode, double tol);
+
+#endif
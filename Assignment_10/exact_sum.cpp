@@ -0,0 +1,134 @@
+/// @file exact_sum.cpp
+/// @author Patrick Deng
+/// @date 2025-05-02
+/// @brief Exact accumulation of sums of doubles, independent of the order of the terms.
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+/// See @ref exact_sum.h
+#include "exact_sum.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+ExactSum::ExactSum()
+  : windowsum_(0), window_(0), inwindow_(0), pending_(0)
+{
+    for (std::int64_t& digit : digits_)
+        digit = 0;
+}
+
+void ExactSum::normalize()
+{
+    for (int d = 0; d < ndigits-1; d++) {
+        std::int64_t carry = digits_[d] >> 32;   // rounds down, also for negative digits
+        digits_[d] &= 0xffffffff;
+        digits_[d+1] += carry;
+    }
+    pending_ = 0;
+}
+
+void ExactSum::flush_window()
+{
+    // four pieces of 32 bits, of which the last one carries the sign
+    int d = window_ >> 5;
+    __int128 rest = windowsum_;
+    for (int piece = 0; piece < 3; piece++) {
+        digits_[d+piece] += std::int64_t(rest & 0xffffffff);
+        rest >>= 32;
+    }
+    digits_[d+3] += std::int64_t(rest);
+    if (++pending_ == maxpending)
+        normalize();
+    windowsum_ = 0;
+    inwindow_ = 0;
+}
+
+void ExactSum::move_window(int position)
+{
+    flush_window();
+    // the term lands in the upper half of the window, so that smaller terms fit below it
+    window_ = position < 32 ? 0 : ((position - 32) & ~31);
+}
+
+void ExactSum::add(const double* x, int n)
+{
+    double rest[blocksize];
+    for (int start = 0; start < n; start += blocksize) {
+        int m = std::min(blocksize, n - start);
+        #pragma omp simd
+        for (int i = 0; i < m; i++)
+            rest[i] = x[start+i];
+        for (int pass = 0; pass <= maxpasses; pass++) {
+            double largest = 0.0;
+            #pragma omp simd reduction(max:largest)
+            for (int i = 0; i < m; i++)
+                largest = std::max(largest, std::fabs(rest[i]));
+            if (largest == 0.0)
+                break;
+            std::uint64_t bits;
+            std::memcpy(&bits, &largest, sizeof bits);
+            int exponent = bits >> 52;
+            if (pass == maxpasses || exponent + blockbits >= 0x7ff) {
+                // tiny, huge or non-finite remainders are added one by one
+                for (int i = 0; i < m; i++)
+                    add(rest[i]);
+                break;
+            }
+            // sigma = 2^blockbits times the power of two above the largest term
+            bits = std::uint64_t(exponent + blockbits) << 52;
+            double sigma;
+            std::memcpy(&sigma, &bits, sizeof sigma);
+            double sum = 0.0;
+            #pragma omp simd reduction(+:sum)
+            for (int i = 0; i < m; i++) {
+                double q = (sigma + rest[i]) - sigma;
+                rest[i] -= q;
+                sum += q;
+            }
+            add(sum);
+        }
+    }
+}
+
+void ExactSum::merge(const ExactSum& other)
+{
+    ExactSum terms = other;
+    terms.flush_window();
+    terms.normalize();
+    flush_window();
+    normalize();
+    for (int d = 0; d < ndigits; d++)
+        digits_[d] += terms.digits_[d];
+    digits_[ndigits] |= terms.digits_[ndigits];
+    normalize();
+}
+
+void ExactSum::allreduce(MPI_Comm comm)
+{
+    // normalized digits are below 2^32, so a sum over up to 2^31 processes cannot overflow
+    flush_window();
+    normalize();
+    MPI_Allreduce(MPI_IN_PLACE, digits_, ndigits+1, MPI_INT64_T, MPI_SUM, comm);
+    normalize();
+}
+
+double ExactSum::value() const
+{
+    if (digits_[ndigits] != 0)
+        return std::numeric_limits<double>::quiet_NaN();
+    ExactSum sum = *this;
+    sum.flush_window();
+    sum.normalize();
+    // a negative sum is converted as its magnitude, which has no negative digits after normalizing
+    bool negative = sum.digits_[ndigits-1] < 0;
+    if (negative) {
+        for (int d = 0; d < ndigits; d++)
+            sum.digits_[d] = -sum.digits_[d];
+        sum.normalize();
+    }
+    // from the most significant digit down, so the small digits only affect the last bits
+    double result = 0.0;
+    for (int d = ndigits-1; d >= 0; d--)
+        if (sum.digits_[d] != 0)
+            result += std::ldexp(double(sum.digits_[d]), 32*d - 1074);
+    return negative ? -result : result;
+}
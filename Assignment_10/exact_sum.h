@@ -0,0 +1,122 @@
+/// @file exact_sum.h
+///
+/// Sums of doubles that do not depend on how the terms are split over
+/// threads and processes.
+///
+/// A floating-point sum rounds after every addition, so its result depends
+/// on the order of the additions, and thus on the number of processes and
+/// threads that compute the partial sums.  An ExactSum instead adds every
+/// term exactly into a long fixed-point accumulator (a "superaccumulator")
+/// that covers the whole range of the doubles: 68 digits of 32 bits, each
+/// held in a 64-bit integer so that carries need not be propagated right
+/// away.  Integer addition is associative, so partial sums can be merged,
+/// also with MPI_SUM over the digits, in any order, and the sum is rounded
+/// to a double only once, at the end.  The result is a function of the
+/// exact sum alone and is therefore bitwise the same for every
+/// decomposition.
+///
+/// To keep add() cheap, the terms are first summed exactly in a 128-bit
+/// integer that covers 64 binary orders of magnitude around the recent
+/// terms.  It is added to the digits every 512 terms, or when a term falls
+/// outside it, in which case it is moved to that term.
+///
+/// Arrays of terms go faster still, because they are split in vectorized
+/// passes.  With sigma a power of two at least 512 times the largest term
+/// of a block of up to 256, q = (sigma + x) - sigma is x rounded to a
+/// multiple of ulp(sigma)/2, x - q is exact, and the q of the block add up
+/// without rounding errors in any order.  Their sum goes into the
+/// accumulator as one term, and the same is repeated on the remainders
+/// x - q, whose largest is at least 2^43 times smaller, until they are zero.
+///
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+///
+#ifndef EXACTSUMH
+#define EXACTSUMH
+
+#include <mpi.h>
+#include <cstdint>
+#include <cstring>
+
+///
+/// @brief Exact accumulator for a sum of doubles
+///
+class ExactSum
+{
+  public:
+    /// @brief an empty sum
+    ExactSum();
+
+    /// @brief add a term exactly; an infinite or NaN term makes the sum NaN
+    void add(double x)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &x, sizeof bits);
+        if ((bits << 1) == 0)
+            return;                                  // +0 or -0
+        int exponent = (bits >> 52) & 0x7ff;
+        if (exponent == 0x7ff) {
+            digits_[ndigits] = 1;
+            return;
+        }
+        // x = mantissa * 2^(position-1074), with position >= 0
+        std::uint64_t mantissa = bits & ((std::uint64_t(1) << 52) - 1);
+        int position = 0;
+        if (exponent > 0) {
+            mantissa |= std::uint64_t(1) << 52;
+            position = exponent - 1;
+        }
+        int offset = position - window_;
+        if (offset < 0 || offset >= windowbits) {
+            move_window(position);
+            offset = position - window_;
+        }
+        __int128 term = __int128(mantissa) << offset;
+        windowsum_ += (bits >> 63) ? -term : term;
+        if (++inwindow_ == maxinwindow)
+            flush_window();
+    }
+
+    /// @brief add the n terms x[0..n-1] exactly
+    void add(const double* x, int n);
+
+    /// @brief add the terms of another sum
+    void merge(const ExactSum& other);
+
+    /// @brief replace the sum on every process of comm by the total over all processes
+    void allreduce(MPI_Comm comm);
+
+    /// @brief the sum, rounded to a double
+    double value() const;
+
+  private:
+    /// digits of 32 bits; digit d has weight 2^(32d-1074), down to the smallest subnormal
+    static const int ndigits = 68;
+    /// binary orders of magnitude covered by the window
+    static const int windowbits = 64;
+    /// terms after which the window is added to the digits (each adds less than 2^117 to it)
+    static const int maxinwindow = 512;
+    /// terms per block of the vectorized add, less than 2^(blockbits-1)
+    static const int blocksize = 256;
+    static const int blockbits = 10;
+    /// vectorized passes over a block, after which remaining terms are added one by one
+    static const int maxpasses = 4;
+    /// additions to the digits after which the carries are propagated (each adds less than 2^33 to a digit)
+    static const int maxpending = 1 << 28;
+
+    /// @brief add the window to the digits and empty it
+    void flush_window();
+
+    /// @brief empty the window and move it so that it covers the given bit position
+    void move_window(int position);
+
+    /// @brief propagate carries, leaving all digits but the last in [0, 2^32)
+    void normalize();
+
+    std::int64_t digits_[ndigits+1];   ///< the digits, and whether a non-finite term was added
+    __int128     windowsum_;           ///< the terms not yet in the digits, in units of 2^(window_-1074)
+    int          window_;              ///< bit position of the lowest bit of the window, a multiple of 32
+    int          inwindow_;            ///< terms added to the window since it was last flushed
+    int          pending_;             ///< additions to the digits since the carries were last propagated
+};
+
+#endif
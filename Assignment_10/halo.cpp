@@ -0,0 +1,62 @@
+/// @file halo.cpp
+/// @author Patrick Deng
+/// @date 2025-05-03
+/// @brief Guard plane exchange of the hybrid solver with subarray datatypes and persistent requests.
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+/// See @ref halo.h
+#include "halo.h"
+#include <iostream>
+
+HaloExchange::HaloExchange(rtensor<double>& u, rtensor<double>& uold, int depth, int left, int right,
+                           MPI_Comm comm)
+  : active_(nullptr)
+{
+    int Ni = u.extent(0);
+    int Nj = u.extent(1);
+    int Nk = u.extent(2);
+    // depth planes without their boundary rows and columns, relative to the first of the planes
+    int sizes[3]    = {depth, Nj, Nk};
+    int subsizes[3] = {depth, Nj-2, Nk-2};
+    int starts[3]   = {0, 1, 1};
+    MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C, MPI_DOUBLE, &face_);
+    MPI_Type_commit(&face_);
+    bytes_ = 0;
+    if (left != MPI_PROC_NULL)
+        bytes_ += sizeof(double)*long(depth)*(Nj-2)*(Nk-2);
+    if (right != MPI_PROC_NULL)
+        bytes_ += sizeof(double)*long(depth)*(Nj-2)*(Nk-2);
+    rtensor<double>* fields[2] = {&u, &uold};
+    for (int f = 0; f < 2; f++) {
+        rtensor<double>& a = *fields[f];
+        data_[f] = a.data();
+        MPI_Recv_init(&a[0][0][0],          1, face_, left,  11, comm, &requests_[f][0]);
+        MPI_Recv_init(&a[Ni-depth][0][0],   1, face_, right, 11, comm, &requests_[f][1]);
+        MPI_Send_init(&a[depth][0][0],      1, face_, left,  11, comm, &requests_[f][2]);
+        MPI_Send_init(&a[Ni-2*depth][0][0], 1, face_, right, 11, comm, &requests_[f][3]);
+    }
+}
+
+HaloExchange::~HaloExchange()
+{
+    for (int f = 0; f < 2; f++)
+        for (MPI_Request& request : requests_[f])
+            MPI_Request_free(&request);
+    MPI_Type_free(&face_);
+}
+
+void HaloExchange::start(const rtensor<double>& a)
+{
+    int f = (a.data() == data_[0]) ? 0 : 1;
+    if (a.data() != data_[f]) {
+        std::cerr << "HaloExchange: the field does not belong to this exchange\n";
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    active_ = requests_[f];
+    MPI_Startall(4, active_);
+}
+
+void HaloExchange::wait()
+{
+    // receives already completed by the caller are inactive, which MPI_Waitall accepts
+    MPI_Waitall(4, active_, MPI_STATUSES_IGNORE);
+}
@@ -0,0 +1,68 @@
+/// @file halo.h
+///
+/// Exchange of the guard planes of the hybrid solver with its neighbours.
+///
+/// Only the interior of a face is sent: the rows j = 0, Nj-1 and columns
+/// k = 0, Nk-1 of a guard plane hold the Dirichlet boundary value, which
+/// every process sets itself and which never changes.  The interior of
+/// the face is described by a committed MPI_Type_create_subarray
+/// datatype, so it is sent straight from the field without packing it
+/// into a buffer first.  The sends and receives are persistent requests,
+/// set up once per run for both time levels of the field (which trade
+/// places every step) and only started and completed in each step.
+///
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+///
+#ifndef HALOH
+#define HALOH
+
+#include <mpi.h>
+#include <rarray>
+
+///
+/// @brief Persistent guard plane exchange for the two time levels of a slab
+///
+class HaloExchange
+{
+  public:
+    ///
+    /// @brief Set up the requests for both fields
+    ///
+    /// @param u, uold the two time levels; they may be swapped with std::swap afterwards
+    /// @param depth   the number of guard planes on either side
+    /// @param left    rank of the left neighbour (or MPI_PROC_NULL)
+    /// @param right   rank of the right neighbour (or MPI_PROC_NULL)
+    /// @param comm    the communicator
+    ///
+    HaloExchange(rtensor<double>& u, rtensor<double>& uold, int depth, int left, int right, MPI_Comm comm);
+
+    /// @brief free the requests and the datatype
+    ~HaloExchange();
+
+    HaloExchange(const HaloExchange&) = delete;
+    HaloExchange& operator=(const HaloExchange&) = delete;
+
+    /// @brief start sending the outer interior planes of a and receiving its guard planes
+    void start(const rtensor<double>& a);
+
+    /// @brief the two receives of the last start(), from the left and from the right
+    MPI_Request* receives() { return active_; }
+
+    /// @brief wait until the exchange started last is complete
+    void wait();
+
+    /// @brief start() and wait()
+    void exchange(const rtensor<double>& a) { start(a); wait(); }
+
+    /// @brief bytes this process sends per exchange
+    long bytes() const { return bytes_; }
+
+  private:
+    MPI_Datatype face_;          ///< the interior of depth planes
+    const double* data_[2];      ///< the fields the requests belong to
+    MPI_Request requests_[2][4]; ///< per field: receive from left and right, send to left and right
+    MPI_Request* active_;        ///< the requests of the last start()
+    long bytes_;                 ///< bytes sent per exchange
+};
+
+#endif
@@ -0,0 +1,187 @@
+/// @file kernels.cpp
+/// @author Patrick Deng
+/// @date 2025-04-28
+/// @brief The update kernels of the hybrid solver and their registry.
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+/// See @ref kernels.h
+#include "kernels.h"
+#include "fd_operators.h"
+#include <algorithm>
+
+/// the 7-point Laplacian, in units of 1/dx^2, from the shared operator library
+using Laplacian7 = fd::Laplacian<3, 2>;
+
+/// the 13-point fourth-order Laplacian, with one-sided closures at the boundaries
+using Laplacian13 = fd::Laplacian<3, 4>;
+
+/// @brief The loops of the MPI-only code: a diffusion sweep and a reaction sweep, without threads
+static void update_serial(rtensor<double>& u, const rtensor<double>& uold, double alpha, double dt)
+{
+    int Ni = u.extent(0);
+    int Nj = u.extent(1);
+    int Nk = u.extent(2);
+    for (int i = 1; i < Ni-1; i++)
+        for (int j = 1; j < Nj-1; j++)
+            for (int k = 1; k < Nk-1; k++)
+                u[i][j][k] = uold[i][j][k]+alpha*Laplacian7::point(uold, i, j, k);
+    for (int i = 1; i < Ni-1; i++)
+        for (int j = 1; j < Nj-1; j++)
+            for (int k = 1; k < Nk-1; k++)
+                u[i][j][k] += dt * uold[i][j][k] * (1-uold[i][j][k]);
+}
+
+/// @brief The original hybrid loops: the same two sweeps, with the j-k loops of every plane shared by the threads
+static void update_omp(rtensor<double>& u, const rtensor<double>& uold, double alpha, double dt)
+{
+    int Ni = u.extent(0);
+    int Nj = u.extent(1);
+    int Nk = u.extent(2);
+    /// Diffusion step through OpenMP parallelization
+    for (int i = 1; i < Ni-1; i++)
+    // OpenMP parallelization is applied to the inner j-k loops (collapse(2)) within a serial i loop
+    // This provides cache locality and lower scheduling overhead than collapse(3),
+    // and avoids false sharing by giving each thread exclusive access to a full j-k slice at fixed i.
+        #pragma omp parallel for collapse(2) schedule(static) default(none) shared(u, uold, alpha, Ni, Nj, Nk, i)
+        for (int j = 1; j < Nj-1; j++)
+            for (int k = 1; k < Nk-1; k++)
+                u[i][j][k] = uold[i][j][k]+alpha*Laplacian7::point(uold, i, j, k);
+    // reaction term update
+    for (int i = 1; i < Ni-1; i++)
+    // The OMP is parallelized over the i-dimension, and the j and k dimensions are collapsed
+        # pragma omp parallel for collapse(2) schedule(static) default(none) shared(u, uold, dt, Ni, Nj, Nk, i)
+        for (int j = 1; j < Nj-1; j++)
+            for (int k = 1; k < Nk-1; k++)
+                u[i][j][k] += dt * uold[i][j][k] * (1-uold[i][j][k]);
+}
+
+/// @brief Diffusion and reaction in a single sweep, in one parallel region over the (i,j) rows
+static void update_fused(rtensor<double>& u, const rtensor<double>& uold, double alpha, double dt)
+{
+    int Ni = u.extent(0);
+    int Nj = u.extent(1);
+    int Nk = u.extent(2);
+    #pragma omp parallel for collapse(2) schedule(static)
+    for (int i = 1; i < Ni-1; i++)
+        for (int j = 1; j < Nj-1; j++)
+            for (int k = 1; k < Nk-1; k++) {
+                double v = uold[i][j][k]+alpha*Laplacian7::point(uold, i, j, k);
+                u[i][j][k] = v + dt * uold[i][j][k] * (1-uold[i][j][k]);
+            }
+}
+
+/// rows of j per tile of the tiled kernel
+static const int tilerows = 8;
+
+/// @brief Fused sweep in tiles of a few j-rows that march through i, so the three
+/// planes a tile reads stay in cache; the tiles are shared by the threads
+static void update_tiled(rtensor<double>& u, const rtensor<double>& uold, double alpha, double dt)
+{
+    int Ni = u.extent(0);
+    int Nj = u.extent(1);
+    int Nk = u.extent(2);
+    int ntiles = (Nj-2 + tilerows-1)/tilerows;
+    #pragma omp parallel for schedule(static)
+    for (int t = 0; t < ntiles; t++) {
+        int j0 = 1 + t*tilerows;
+        int j1 = std::min(j0 + tilerows, Nj-1);
+        for (int i = 1; i < Ni-1; i++)
+            for (int j = j0; j < j1; j++)
+                for (int k = 1; k < Nk-1; k++) {
+                    double v = uold[i][j][k]+alpha*Laplacian7::point(uold, i, j, k);
+                    u[i][j][k] = v + dt * uold[i][j][k] * (1-uold[i][j][k]);
+                }
+    }
+}
+
+/// @brief Fused sweep on raw row pointers, with the k loop explicitly vectorized
+static void update_simd(rtensor<double>& u, const rtensor<double>& uold, double alpha, double dt)
+{
+    int Ni = u.extent(0);
+    int Nj = u.extent(1);
+    int Nk = u.extent(2);
+    #pragma omp parallel for collapse(2) schedule(static)
+    for (int i = 1; i < Ni-1; i++) {
+        for (int j = 1; j < Nj-1; j++) {
+            double* __restrict out      = &u[i][j][0];
+            const double* __restrict c  = &uold[i][j][0];
+            const double* __restrict im = &uold[i-1][j][0];
+            const double* __restrict ip = &uold[i+1][j][0];
+            const double* __restrict jm = &uold[i][j-1][0];
+            const double* __restrict jp = &uold[i][j+1][0];
+            #pragma omp simd
+            for (int k = 1; k < Nk-1; k++) {
+                double v = c[k]+alpha*(im[k]+ip[k]+jm[k]+jp[k]+c[k-1]+c[k+1]-6*c[k]);
+                out[k] = v + dt * c[k] * (1-c[k]);
+            }
+        }
+    }
+}
+
+const Kernel kernels[] = {
+    {"omp",    "j-k loops of each plane shared by the threads, separate reaction sweep", update_omp},
+    {"serial", "plain loops without threads, as in the MPI-only code",               update_serial},
+    {"fused",  "diffusion and reaction in one sweep over the (i,j) rows",             update_fused},
+    {"tiled",  "fused sweep in tiles of j-rows marching through i",                   update_tiled},
+    {"simd",   "fused sweep on row pointers with a vectorized k loop",                update_simd},
+};
+
+const int nkernels = sizeof(kernels)/sizeof(kernels[0]);
+
+void update_fourth_order(rtensor<double>& u, const rtensor<double>& uold, double alpha, double dt,
+                         bool lowboundary, bool highboundary)
+{
+    int Ni = u.extent(0);
+    int Nj = u.extent(1);
+    int Nk = u.extent(2);
+    #pragma omp parallel for collapse(2) schedule(static)
+    for (int i = 2; i < Ni-2; i++) {
+        for (int j = 1; j < Nj-1; j++) {
+            bool lowi = lowboundary && i == 2;
+            bool highi = highboundary && i == Ni-3;
+            const double* c = &uold[i][j][0];
+            for (int k = 1; k < Nk-1; k++)
+                u[i][j][k] = c[k] + alpha*Laplacian13::point(uold, i, j, k, lowi, highi) + dt * c[k] * (1-c[k]);
+        }
+    }
+}
+
+void react_exact(rtensor<double>& u, const fd::LogisticStep& react, int depth)
+{
+    int Ni = u.extent(0);
+    int Nj = u.extent(1);
+    int Nk = u.extent(2);
+    #pragma omp parallel for collapse(2) schedule(static)
+    for (int i = depth; i < Ni-depth; i++)
+        for (int j = 1; j < Nj-1; j++)
+            for (int k = 1; k < Nk-1; k++)
+                u[i][j][k] = react(u[i][j][k]);
+}
+
+void diffuse_react(rtensor<double>& u, const rtensor<double>& uold, double alpha, const fd::LogisticStep& react,
+                   int order, bool lowboundary, bool highboundary)
+{
+    int Ni = u.extent(0);
+    int Nj = u.extent(1);
+    int Nk = u.extent(2);
+    int depth = order/2;
+    #pragma omp parallel for collapse(2) schedule(static)
+    for (int i = depth; i < Ni-depth; i++) {
+        for (int j = 1; j < Nj-1; j++) {
+            bool lowi = lowboundary && i == depth;
+            bool highi = highboundary && i == Ni-1-depth;
+            for (int k = 1; k < Nk-1; k++) {
+                double laplacian = (order == 4) ? Laplacian13::point(uold, i, j, k, lowi, highi)
+                                                : Laplacian7::point(uold, i, j, k);
+                u[i][j][k] = react(uold[i][j][k] + alpha*laplacian);
+            }
+        }
+    }
+}
+
+int find_kernel(const std::string& name)
+{
+    for (int n = 0; n < nkernels; n++)
+        if (name == kernels[n].name)
+            return n;
+    return -1;
+}
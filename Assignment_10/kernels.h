@@ -0,0 +1,98 @@
+/// @file kernels.h
+///
+/// Registry of interchangeable update kernels for the time step of the
+/// hybrid solver.  Every kernel computes the same explicit Euler step of
+/// the diffusion and reaction terms on the interior of a slab,
+///
+///   u = uold + alpha*(7-point Laplacian of uold) + dt*uold*(1-uold),
+///
+/// but with a different loop organization and parallelization.  A kernel
+/// is selected at run time by name (--kernel), and --bench-kernels times
+/// all of them on the same decomposition.
+///
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+///
+#ifndef KERNELSH
+#define KERNELSH
+
+#include <rarray>
+#include <string>
+#include "fd_operators.h"
+
+/// Type of the update kernels
+typedef void (*kernel_function)(rtensor<double>& u, const rtensor<double>& uold, double alpha, double dt);
+
+///
+/// @brief An entry in the registry
+///
+struct Kernel {
+    const char*     name;        ///< name used on the command line
+    const char*     description; ///< one-line description for the help text
+    kernel_function update;      ///< the kernel itself
+};
+
+/// The registered kernels; the first one is the default
+extern const Kernel kernels[];
+
+/// Number of registered kernels
+extern const int nkernels;
+
+///
+/// @brief Time step with a fourth-order (13-point) Laplacian instead of the 7-point one
+///
+/// Needs two guard planes on each side in i.  At the points next to a
+/// Dirichlet boundary, the second difference in that direction uses the
+/// one-sided fourth-order closure
+/// (10 u[b] - 15 u[b+1] - 4 u[b+2] + 14 u[b+3] - 6 u[b+4] + u[b+5])/12,
+/// with b the boundary point.  Not part of the registry, since it is a
+/// different discretization rather than a different loop organization.
+///
+/// @param u            the field to update
+/// @param uold         the field at the previous time step, including guard planes
+/// @param alpha        D/dx^2
+/// @param dt           the time step
+/// @param lowboundary  whether plane 1 is the boundary at x=0 (on the first process)
+/// @param highboundary whether plane Ni-2 is the boundary at x=L (on the last process)
+///
+void update_fourth_order(rtensor<double>& u, const rtensor<double>& uold, double alpha, double dt,
+                         bool lowboundary, bool highboundary);
+
+///
+/// @brief Exact logistic reaction over one step on the interior planes of u
+///
+/// One of the reaction sub-steps of the Strang-split time step (--strang).
+///
+/// @param u     the field; its depth guard planes on either side are not touched
+/// @param react the exact reaction over the sub-step
+/// @param depth the number of guard planes on either side
+///
+void react_exact(rtensor<double>& u, const fd::LogisticStep& react, int depth);
+
+///
+/// @brief Explicit diffusion step followed by the exact reaction, in one sweep
+///
+/// u = react(uold + alpha*(Laplacian of uold)), the diffusion and trailing
+/// reaction sub-steps of the Strang-split time step.  The Laplacian is the
+/// 7-point one, or the 13-point one of update_fourth_order().
+///
+/// @param u            the field to update
+/// @param uold         the field after the leading reaction sub-step, including guard planes
+/// @param alpha        D/dx^2
+/// @param react        the exact reaction over the trailing sub-step
+/// @param order        order of the Laplacian, 2 or 4
+/// @param lowboundary  whether this process holds the boundary at x=0 (only used by order 4)
+/// @param highboundary whether this process holds the boundary at x=L (only used by order 4)
+///
+void diffuse_react(rtensor<double>& u, const rtensor<double>& uold, double alpha, const fd::LogisticStep& react,
+                   int order, bool lowboundary, bool highboundary);
+
+///
+/// @brief Look up a kernel by name
+///
+/// @param name the name of the kernel
+///
+/// @returns the index of the kernel in kernels[], or -1 if there is none by that name
+///
+int find_kernel(const std::string& name);
+
+#endif
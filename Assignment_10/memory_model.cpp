@@ -0,0 +1,86 @@
+/// @file memory_model.cpp
+/// @author Patrick Deng
+/// @date 2025-05-01
+/// @brief Weak-scaling problem sizes and the memory model of the hybrid solver.
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+/// See @ref memory_model.h
+#include "memory_model.h"
+#include "compress.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+
+/// resident memory of a process of the solver before it allocates its fields, measured with Open MPI 4.1
+static const double runtime_bytes = 16.0e6;
+
+/// buffer of the processes that aggregate the data of a collective write, unless cb_buffer_size says otherwise;
+/// this is the default of the ompio component of Open MPI 4.1 (ROMIO uses 16 MB)
+static const double aggregation_bytes = 32.0e6;
+
+/// @brief the aggregation buffer of collective writes, from the cb_buffer_size hint if there is one
+static double aggregation_buffer(const Param& p)
+{
+    std::string hints(p.iohints);
+    std::size_t pos = hints.find("cb_buffer_size=");
+    if (pos == std::string::npos)
+        return aggregation_bytes;
+    return std::atof(hints.c_str() + pos + 15);
+}
+
+int weak_scaling_points(double cells_per_rank, int size)
+{
+    // the interior of (N-2)^3 points is divided in slabs over the processes
+    return 2 + int(std::lround(std::cbrt(cells_per_rank*size)));
+}
+
+double output_bytes_per_point(const Param& p)
+{
+    if (p.compress == COMPRESS_NONE)
+        return 80.0;           // five columns of 16 characters
+    // the compressed planes (a little over 8 bytes per value in the worst case) and their concatenation
+    return 2*8.5;
+}
+
+MemoryEstimate estimate_memory(const Param& p, int size)
+{
+    double n = p.N - 2;
+    double planes = std::ceil(n/size);               // interior planes of the thickest slab
+    double points = (planes + p.order)*p.N*double(p.N);
+    MemoryEstimate m;
+    int copies = p.benchkernels > 0 ? 4 : 2;         // the benchmark also keeps a result and a reference
+    m.fields = copies*sizeof(double)*points;
+    m.output = 0.0;
+    if (p.benchkernels == 0) {
+        m.output = output_bytes_per_point(p)*planes*n*n;
+        // an aggregator of the collective write buffers part of the snapshot of all processes
+        if (size > 1)
+            m.output += std::min(aggregation_buffer(p), output_bytes_per_point(p)*n*n*n);
+    }
+    m.runtime = runtime_bytes;
+    m.total = m.fields + m.output + m.runtime;
+    return m;
+}
+
+double node_memory()
+{
+    double bytes = double(sysconf(_SC_PHYS_PAGES))*sysconf(_SC_PAGE_SIZE);
+    // a container may have less than the machine; cgroup v2 and v1 put the limit in different files
+    for (const char* limitfile : {"/sys/fs/cgroup/memory.max", "/sys/fs/cgroup/memory/memory.limit_in_bytes"}) {
+        std::ifstream in(limitfile);
+        double limit;
+        if (in >> limit && limit > 0)
+            bytes = std::min(bytes, limit);
+    }
+    return bytes;
+}
+
+double peak_memory()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss*1024.0;                   // Linux reports kilobytes
+}
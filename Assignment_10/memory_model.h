@@ -0,0 +1,58 @@
+/// @file memory_model.h
+///
+/// Problem sizes for weak-scaling runs, and a model of the memory the
+/// hybrid solver needs per process, so that a configuration that does not
+/// fit on a node is refused before anything is allocated instead of being
+/// killed halfway through the run.
+///
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+///
+#ifndef MEMORYMODELH
+#define MEMORYMODELH
+
+#include "params.h"
+
+///
+/// @brief Memory needed by the process with the thickest slab, in bytes
+///
+struct MemoryEstimate {
+    double fields;   ///< u and uold, with guard planes and boundaries (and the copies of --bench-kernels)
+    double output;   ///< buffers for writing one snapshot, including the aggregation buffer of MPI-IO
+    double runtime;  ///< the MPI and OpenMP runtimes and the executable
+    double total;    ///< sum of the above
+};
+
+///
+/// @brief Number of grid points per direction that gives every process about the given number of cells
+///
+/// @param cells_per_rank interior points per process
+/// @param size           number of processes
+///
+int weak_scaling_points(double cells_per_rank, int size);
+
+///
+/// @brief Bytes per interior point in the buffers of one snapshot
+///
+/// @param p the parameters; the text output takes 80, the compressed output at most about 17
+///
+double output_bytes_per_point(const Param& p);
+
+///
+/// @brief Predict the memory use of the process with the thickest slab
+///
+/// @param p    the parameters
+/// @param size number of processes sharing the domain
+///
+MemoryEstimate estimate_memory(const Param& p, int size);
+
+///
+/// @brief Memory available to this process's node (or container), in bytes
+///
+double node_memory();
+
+///
+/// @brief Peak resident memory of this process so far, in bytes
+///
+double peak_memory();
+
+#endif
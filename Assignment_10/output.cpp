@@ -30,6 +30,8 @@ void output(std::string fn, double t, double dx, const rtensor<double>&a, MPI_Co
     int isize = a.extent(0)-2;
     int ioffset = 0;
     MPI_Exscan(&isize, &ioffset, 1, MPI_INT, MPI_SUM, comm);
+    if (rank == 0)
+        ioffset = 0;        // MPI_Exscan leaves it undefined on rank 0
     // print a log message
     if (rank == 0) {
         std::cout << "Computation is at time " << t << '\n';
@@ -64,11 +66,13 @@ void output(std::string fn, double t, double dx, const rtensor<double>&a, MPI_Co
     }
     // write with Collective MPI-IO
     MPI_Offset offset = 0;
-    MPI_Exscan(&numchars, &offset, 1, MPI_INT, MPI_SUM, comm);
+    MPI_Exscan(&numchars, &offset, 1, MPI_OFFSET, MPI_SUM, comm);
+    if (rank == 0)
+        offset = 0;
     MPI_File file;
     if (t == 0.0)  {
         if (rank == 0)
-            if (std::filesystem::exists(fn))
+            if (std::filesystem::is_regular_file(fn))
                 std::filesystem::remove(fn);
         MPI_Barrier(comm);
         MPI_File_open(comm, fn.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file);
@@ -77,6 +81,7 @@ void output(std::string fn, double t, double dx, const rtensor<double>&a, MPI_Co
         MPI_Offset filesize;
         MPI_File_get_size(file, &filesize);
         offset += filesize;
+        MPI_Barrier(comm);  // all sizes must be read before any process appends
     }
     MPI_File_write_at_all(file, offset, &asciistr[0], numchars, MPI_CHAR, MPI_STATUS_IGNORE);
     MPI_File_close(&file);
@@ -0,0 +1,105 @@
+/// @file output_compressed.cpp
+/// @author Patrick Deng
+/// @date 2025-04-27
+/// @brief Compressed binary snapshots with per-plane offset tables, written with collective MPI-IO.
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+/// See @ref output_compressed.h
+#include "output_compressed.h"
+#include "compress.h"
+#include "output_hybrid.h"
+#include <iostream>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+CompressedOutput::CompressedOutput(const std::string& fn, int mode, double tol, MPI_Comm comm,
+                                   const std::string& hints)
+  : comm_(comm), mode_(mode), tol_(tol), offset_(0)
+{
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if (rank == 0 && std::filesystem::is_regular_file(fn))   // not devices such as /dev/null
+        std::filesystem::remove(fn);
+    MPI_Barrier(comm);
+    MPI_Info info = make_io_hints(hints);
+    MPI_File_open(comm, fn.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, info, &file_);
+    if (info != MPI_INFO_NULL)
+        MPI_Info_free(&info);
+}
+
+CompressedOutput::~CompressedOutput()
+{
+    MPI_File_close(&file_);
+}
+
+void CompressedOutput::write(double t, double dx, const rtensor<double>& a, int guard)
+{
+    int rank, size;
+    MPI_Comm_rank(comm_, &rank);
+    MPI_Comm_size(comm_, &size);
+    int ni = a.extent(0) - 2*guard;
+    int n  = a.extent(1) - 2;
+    if (rank == 0)
+        std::cout << "Computation is at time " << t << '\n';
+    // compress every plane independently
+    std::vector<std::vector<char>> planes(ni);
+    #pragma omp parallel
+    {
+        std::vector<double> values(std::size_t(n)*n);
+        #pragma omp for schedule(dynamic)
+        for (int i = 0; i < ni; i++) {
+            for (int j = 0; j < n; j++)
+                for (int k = 0; k < n; k++)
+                    values[std::size_t(j)*n + k] = a[i+guard][j+1][k+1];
+            planes[i] = compress_values(values.data(), values.size(), mode_, tol_);
+        }
+    }
+    std::vector<unsigned long long> sizes(ni);
+    long long local = 0;
+    for (int i = 0; i < ni; i++) {
+        sizes[i] = planes[i].size();
+        local += planes[i].size();
+    }
+    // the table of all plane sizes goes into the header written by rank 0
+    std::vector<int> counts(size), displs(size);
+    MPI_Gather(&ni, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, comm_);
+    int nplanes = 0;
+    for (int r = 0; r < size; r++) {
+        displs[r] = nplanes;
+        nplanes += counts[r];
+    }
+    MPI_Bcast(&nplanes, 1, MPI_INT, 0, comm_);
+    std::vector<unsigned long long> table(rank == 0 ? nplanes : 0);
+    MPI_Gatherv(sizes.data(), ni, MPI_UNSIGNED_LONG_LONG,
+                table.data(), counts.data(), displs.data(), MPI_UNSIGNED_LONG_LONG, 0, comm_);
+    MPI_Offset headerbytes = sizeof(SnapshotHeader) + sizeof(unsigned long long)*nplanes;
+    long long before = 0, total = 0;
+    MPI_Exscan(&local, &before, 1, MPI_LONG_LONG, MPI_SUM, comm_);
+    if (rank == 0)
+        before = 0;
+    MPI_Allreduce(&local, &total, 1, MPI_LONG_LONG, MPI_SUM, comm_);
+    // rank 0 writes the header in front of its planes, so one collective write suffices
+    std::vector<char> buffer;
+    buffer.reserve(local + (rank == 0 ? headerbytes : 0));
+    if (rank == 0) {
+        SnapshotHeader header;
+        std::memcpy(header.magic, "PKZ1", 4);
+        header.mode = mode_;
+        header.n = n;
+        header.nplanes = nplanes;
+        header.t = t;
+        header.dx = dx;
+        header.tol = tol_;
+        const char* h = reinterpret_cast<const char*>(&header);
+        buffer.insert(buffer.end(), h, h + sizeof(header));
+        const char* tb = reinterpret_cast<const char*>(table.data());
+        buffer.insert(buffer.end(), tb, tb + sizeof(unsigned long long)*nplanes);
+    }
+    for (const std::vector<char>& plane : planes)
+        buffer.insert(buffer.end(), plane.begin(), plane.end());
+    MPI_Offset offset = offset_ + (rank == 0 ? 0 : headerbytes + before);
+    write_at_all(file_, offset, buffer.data(), buffer.size(), comm_);
+    offset_ += headerbytes + total;
+    if (rank == 0)
+        std::cout << "#compressed " << total << " of " << 8LL*nplanes*n*n << " bytes\n";
+}
@@ -0,0 +1,77 @@
+/// @file output_compressed.h
+///
+/// Write compressed binary snapshots of the field, as an alternative to
+/// the five-column text output of output_hybrid().
+///
+/// Every snapshot in the file consists of
+/// - a SnapshotHeader,
+/// - a table with the compressed size in bytes (uint64) of each interior i-plane,
+/// - the compressed i-planes, in order, each holding n x n values in (j,k) order.
+///
+/// The planes are compressed independently (see @ref compress.h), in
+/// parallel with OpenMP, and every process writes its planes at an offset
+/// computed from the sizes of those of the processes before it.  The file
+/// stays open between snapshots and the end of the file is tracked locally.
+///
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+///
+#ifndef OUTPUTCOMPRESSEDH
+#define OUTPUTCOMPRESSEDH
+
+#include <mpi.h>
+#include <rarray>
+#include <cstdint>
+#include <string>
+
+///
+/// @brief Header of every snapshot in a compressed file
+///
+struct SnapshotHeader {
+    char         magic[4]; ///< "PKZ1"
+    std::int32_t mode;     ///< CompressionMode
+    std::int32_t n;        ///< interior points per direction
+    std::int32_t nplanes;  ///< number of i-planes that follow
+    double       t;        ///< time
+    double       dx;       ///< grid spacing
+    double       tol;      ///< error bound of the lossy mode
+};
+
+///
+/// @brief A compressed snapshot file that is open for the duration of a simulation
+///
+class CompressedOutput
+{
+  public:
+    ///
+    /// @brief Create (or overwrite) the file
+    ///
+    /// @param fn   the name of the file to write to
+    /// @param mode COMPRESS_LOSSLESS or COMPRESS_LOSSY
+    /// @param tol  absolute error bound for COMPRESS_LOSSY
+    /// @param comm MPI communicator
+    /// @param hints MPI-IO hints, see make_io_hints()
+    ///
+    CompressedOutput(const std::string& fn, int mode, double tol, MPI_Comm comm, const std::string& hints = "");
+    ~CompressedOutput();
+    CompressedOutput(const CompressedOutput&) = delete;
+    CompressedOutput& operator=(const CompressedOutput&) = delete;
+
+    ///
+    /// @brief Append a snapshot of the interior of a.  Omits the boundary and guard cells.
+    ///
+    /// @param t  time
+    /// @param dx grid spacing
+    /// @param a  field at time t, with guard planes in i and boundaries in j and k
+    /// @param guard number of guard planes on each side in i
+    ///
+    void write(double t, double dx, const rtensor<double>& a, int guard = 1);
+
+  private:
+    MPI_Comm comm_;
+    MPI_File file_;
+    int mode_;
+    double tol_;
+    MPI_Offset offset_;          ///< end of the file, the same on all processes
+};
+
+#endif
@@ -9,6 +9,9 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
 #include <omp.h>
 #include <filesystem>
 
@@ -23,17 +26,81 @@ std::string double_to_string(double value, int width, int precision)
 }
 
 
-void output_hybrid(std::string fn, double t, double dx, const rtensor<double>& a, MPI_Comm comm)
+void write_at_all(MPI_File file, MPI_Offset offset, const char* data, MPI_Offset bytes, MPI_Comm comm)
+{
+    const MPI_Offset chunk = MPI_Offset(1) << 30;
+    MPI_Offset rounds = (bytes + chunk - 1)/chunk;
+    MPI_Allreduce(MPI_IN_PLACE, &rounds, 1, MPI_OFFSET, MPI_MAX, comm);
+    for (MPI_Offset r = 0; r < rounds; r++) {
+        // processes with fewer bytes take part with an empty write
+        MPI_Offset start = std::min(r*chunk, bytes);
+        int count = int(std::min(chunk, bytes - start));
+        MPI_File_write_at_all(file, offset + start, data + start, count, MPI_CHAR, MPI_STATUS_IGNORE);
+    }
+}
+
+MPI_Info make_io_hints(const std::string& hints)
+{
+    if (hints.empty())
+        return MPI_INFO_NULL;
+    MPI_Info info;
+    MPI_Info_create(&info);
+    std::istringstream list(hints);
+    std::string hint;
+    while (std::getline(list, hint, ',')) {
+        std::size_t eq = hint.find('=');
+        if (eq != std::string::npos && eq > 0)
+            MPI_Info_set(info, hint.substr(0, eq).c_str(), hint.substr(eq+1).c_str());
+    }
+    return info;
+}
+
+TextOutput::TextOutput(const std::string& fn, MPI_Comm comm, const std::string& hints)
+  : comm_(comm), offset_(0)
+{
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if (rank == 0 && std::filesystem::is_regular_file(fn))   // not devices such as /dev/null
+        std::filesystem::remove(fn);
+    MPI_Barrier(comm);
+    MPI_Info info = make_io_hints(hints);
+    MPI_File_open(comm, fn.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, info, &file_);
+    if (info != MPI_INFO_NULL) {
+        // report the hints that the MPI library accepted
+        MPI_Info used;
+        MPI_File_get_info(file_, &used);
+        int nkeys;
+        MPI_Info_get_nkeys(info, &nkeys);
+        for (int n = 0; n < nkeys && rank == 0; n++) {
+            char key[MPI_MAX_INFO_KEY+1], val[MPI_MAX_INFO_VAL+1];
+            int flag;
+            MPI_Info_get_nthkey(info, n, key);
+            MPI_Info_get(used, key, MPI_MAX_INFO_VAL, val, &flag);
+            std::cout << "#io hint " << key << " = " << (flag ? val : "(ignored)") << '\n';
+        }
+        MPI_Info_free(&used);
+        MPI_Info_free(&info);
+    }
+}
+
+TextOutput::~TextOutput()
+{
+    MPI_File_close(&file_);
+}
+
+void TextOutput::write(double t, double dx, const rtensor<double>& a, int guard)
 {
     // Determine MPI rank and size.
     int rank, size;
-    MPI_Comm_rank(comm, &rank);
-    MPI_Comm_size(comm, &size);
+    MPI_Comm_rank(comm_, &rank);
+    MPI_Comm_size(comm_, &size);
     
-    // The number of "inner" i indices (excluding boundaries).
-    int isize = a.extent(0) - 2;
+    // The number of "inner" i indices (excluding boundaries and guard planes).
+    int isize = a.extent(0) - 2*guard;
     int ioffset = 0;
-    MPI_Exscan(&isize, &ioffset, 1, MPI_INT, MPI_SUM, comm);
+    MPI_Exscan(&isize, &ioffset, 1, MPI_INT, MPI_SUM, comm_);
+    if (rank == 0)
+        ioffset = 0;        // MPI_Exscan leaves it undefined on rank 0
     
     // Log the current simulation time.
     if (rank == 0) {
@@ -50,13 +117,14 @@ void output_hybrid(std::string fn, double t, double dx, const rtensor<double>& a
     int N = a.extent(2) - 2; // number of k iterations
     // Calculate the number of characters that will be produced per i-slice.
     int chars_per_i = (M * N * 5 * colwidth + 1);
-    MPI_Offset numchars = chars_per_i * (a.extent(0) - 2);
+    MPI_Offset numchars = MPI_Offset(chars_per_i) * isize;
     
-    // Allocate one string per i-slice in a vector so that each thread writes its own buffer.
-    int i_min = 1;
-    int i_max = a.extent(0) - 1; // i iterates from 1 to a.extent(0)-1 (i.e. total slices = a.extent(0)-2)
-    int num_slices = i_max - i_min;
-    std::vector<std::string> slices(num_slices, std::string(chars_per_i, ' '));
+    // Format straight into the buffer that is written, one i-slice per thread at a time, so that
+    // the text is held in memory only once (see output_bytes_per_point() in memory_model.h).
+    int i_min = guard;
+    int i_max = a.extent(0) - guard; // i iterates from guard to a.extent(0)-guard (i.e. total slices = isize)
+    std::string asciistr(numchars, ' ');
+    char* buffer = &asciistr[0];
     
     // Define bounds for j and k loops.
     int j_min = 1;
@@ -66,12 +134,12 @@ void output_hybrid(std::string fn, double t, double dx, const rtensor<double>& a
     
     // Parallelize over the i-slices using OpenMP.
     #pragma omp parallel for schedule(static) default(none) \
-        shared(a, dx, colwidth, numwidth, precision_val, slices, i_min, i_max, j_min, j_max, k_min, k_max, t, ioffset, chars_per_i)
+        shared(a, dx, colwidth, numwidth, precision_val, buffer, i_min, i_max, j_min, j_max, k_min, k_max, t, ioffset, chars_per_i, guard)
     // Parallelizing over i-slices provides coarse-grained, cache-friendly work units per thread.
-    // Avoids thread contention and allows safe, independent writes to each slice buffer.
+    // Avoids thread contention and allows safe, independent writes to each slice of the buffer.
     for (int i = i_min; i < i_max; i++) {
-        // Access the buffer for this i-slice.
-        std::string &slice = slices[i - i_min];
+        // The part of the buffer for this i-slice.
+        char* slice = buffer + std::size_t(i - i_min) * chars_per_i;
         
         // Loop over j and k within this slice.
         for (int j = j_min; j < j_max; j++) {
@@ -81,48 +149,33 @@ void output_hybrid(std::string fn, double t, double dx, const rtensor<double>& a
             for (int k = k_min; k < k_max; k++) {
                 // Compute the starting position for each (i, j, k) cell in the slice.
                 int pos_elem = pos_ij + (k - k_min) * 5 * colwidth;
-                double x = (ioffset + i) * dx;
+                double x = (ioffset + i - guard + 1) * dx;
                 double y = j * dx;
                 double z = k * dx;
                 
                 // Write the five fields in sequence: time, x, y, z, and the field value a[i][j][k].
-                slice.replace(pos_elem,          numwidth, double_to_string(t, numwidth, precision_val));
+                std::memcpy(slice + pos_elem, double_to_string(t, numwidth, precision_val).data(), numwidth);
                 pos_elem += colwidth;
-                slice.replace(pos_elem,          numwidth, double_to_string(x, numwidth, precision_val));
+                std::memcpy(slice + pos_elem, double_to_string(x, numwidth, precision_val).data(), numwidth);
                 pos_elem += colwidth;
-                slice.replace(pos_elem,          numwidth, double_to_string(y, numwidth, precision_val));
+                std::memcpy(slice + pos_elem, double_to_string(y, numwidth, precision_val).data(), numwidth);
                 pos_elem += colwidth;
-                slice.replace(pos_elem,          numwidth, double_to_string(z, numwidth, precision_val));
+                std::memcpy(slice + pos_elem, double_to_string(z, numwidth, precision_val).data(), numwidth);
                 pos_elem += colwidth;
-                slice.replace(pos_elem, colwidth, double_to_string(a[i][j][k], numwidth, precision_val) + "\n");
+                std::memcpy(slice + pos_elem, double_to_string(a[i][j][k], numwidth, precision_val).data(), numwidth);
+                slice[pos_elem + numwidth] = '\n';
             } // end k loop
         } // end j loop
         // At the end of the i-slice, add an extra newline.
-        slice.replace(chars_per_i - 1, 1, "\n");
+        slice[chars_per_i - 1] = '\n';
     } // end i loop
     
-    // Combine all slices into one contiguous output string.
-    std::string asciistr;
-    asciistr.reserve(numchars);
-    for (const auto &s : slices) {
-        asciistr.append(s);
-    }
-    
-    // Write the combined ASCII string using collective MPI I/O.
-    MPI_Offset offset = 0;
-    MPI_Exscan(&numchars, &offset, 1, MPI_INT, MPI_SUM, comm);
-    MPI_File file;
-    if (t == 0.0) {
-        if (rank == 0 && std::filesystem::exists(fn))
-            std::filesystem::remove(fn);
-        MPI_Barrier(comm);
-        MPI_File_open(comm, fn.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file);
-    } else {
-        MPI_File_open(comm, fn.c_str(), MPI_MODE_APPEND | MPI_MODE_WRONLY, MPI_INFO_NULL, &file);
-        MPI_Offset filesize;
-        MPI_File_get_size(file, &filesize);
-        offset += filesize;
-    }
-    MPI_File_write_at_all(file, offset, asciistr.data(), numchars, MPI_CHAR, MPI_STATUS_IGNORE);
-    MPI_File_close(&file);
-}
\ No newline at end of file
+    // Write the combined ASCII string using collective MPI I/O, after the previous snapshots.
+    MPI_Offset offset = 0, total = 0;
+    MPI_Exscan(&numchars, &offset, 1, MPI_OFFSET, MPI_SUM, comm_);
+    if (rank == 0)
+        offset = 0;
+    MPI_Allreduce(&numchars, &total, 1, MPI_OFFSET, MPI_SUM, comm_);
+    write_at_all(file_, offset_ + offset, asciistr.data(), numchars, comm_);
+    offset_ += total;
+}
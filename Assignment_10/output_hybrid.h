@@ -1,8 +1,13 @@
 /// @file output_hybrid.h
 ///
-/// Write the elements of the field at time t to console in five-column format
+/// Write the elements of the field at time t to a file in five-column format
 /// (t, x, y, z, a[t,x,y,z])
 ///
+/// The file is opened once for all snapshots of a run, and the end of the
+/// file is tracked by every process instead of being asked from the file
+/// system, which saves the metadata operations that an open, a size query
+/// and a close per snapshot cost on a parallel file system.
+///
 /// Part of the assignment 10.
 ///
 #ifndef OUTPUTH
@@ -10,17 +15,65 @@
 
 #include <mpi.h>
 #include <rarray>
+#include <string>
 
 ///
-/// @brief output routine to a file.  Omits the boundary and guard cells.
+/// @brief Create MPI-IO hints from a list of the form "key=value,key=value"
+///
+/// Typical keys are cb_nodes, cb_buffer_size and striping_factor.
 ///
-/// @param fn   the name of the file to write to.
-/// @param t    time (double)
-/// @param dx   grid spacing (double)
-/// @param a    field at time t (rtensor<double>)
-/// @param comm MPI communicator
+/// @param hints the list; may be empty
 ///
-void output_hybrid(std::string fn, double t, double dx, const rtensor<double>&a, MPI_Comm comm);
+/// @returns the hints, or MPI_INFO_NULL if there are none; free with MPI_Info_free otherwise
+///
+MPI_Info make_io_hints(const std::string& hints);
 
-#endif
+///
+/// @brief Collective write of any number of bytes per process
+///
+/// MPI counts are ints, so the bytes are written in rounds of at most
+/// 1 GiB, with the same number of rounds on every process.
+///
+/// @param file   the file, opened on comm
+/// @param offset where this process's bytes go in the file
+/// @param data   the bytes
+/// @param bytes  the number of bytes, which may differ between the processes
+/// @param comm   the communicator the file was opened on
+///
+void write_at_all(MPI_File file, MPI_Offset offset, const char* data, MPI_Offset bytes, MPI_Comm comm);
+
+///
+/// @brief A text output file that is open for the duration of a simulation
+///
+class TextOutput
+{
+  public:
+    ///
+    /// @brief Create (or overwrite) the file
+    ///
+    /// @param fn    the name of the file to write to
+    /// @param comm  MPI communicator
+    /// @param hints MPI-IO hints in the form of make_io_hints(); rank 0 reports the ones in effect
+    ///
+    TextOutput(const std::string& fn, MPI_Comm comm, const std::string& hints = "");
+    ~TextOutput();
+    TextOutput(const TextOutput&) = delete;
+    TextOutput& operator=(const TextOutput&) = delete;
 
+    ///
+    /// @brief Append a snapshot.  Omits the boundary and guard cells.
+    ///
+    /// @param t     time (double)
+    /// @param dx    grid spacing (double)
+    /// @param a     field at time t (rtensor<double>)
+    /// @param guard number of guard planes on each side in i (2 for the fourth-order stencil)
+    ///
+    void write(double t, double dx, const rtensor<double>& a, int guard = 1);
+
+  private:
+    MPI_Comm comm_;
+    MPI_File file_;
+    MPI_Offset offset_;          ///< end of the file, the same on all processes
+};
+
+#endif
@@ -3,7 +3,17 @@
 /// Header to define the struct to hold parameters:
 /// P (number of snapshots to output), L (length of the interval), A
 /// (amplitude of the boundary driving), N (number of grid points), T
-/// (time to simulate), and D (time step), and F (filename)
+/// (time to simulate), and D (time step), and F (filename), plus the
+/// number of probe steps used by the hybrid code's autotuner, whether it
+/// uses its task-based time step, the tile size for skipping quiescent
+/// regions, the block size, relative refinement threshold, regrid interval and refinement ratio of
+/// the adaptive mesh refinement code, the compression of the hybrid
+/// code's snapshots, the hybrid code's update kernel, the number of steps
+/// to benchmark all kernels with, the order of its Laplacian, the MPI-IO
+/// hints for its output file, the cells per process of a weak-scaling run,
+/// the memory per node it may use, the steps between its reproducible
+/// diagnostics, and whether the hybrid and spectral codes use Strang
+/// splitting
 ///
 /// Part of assignment 10 of the PHY1610 Winter 2025 course.
 ///
@@ -21,9 +31,27 @@ struct Param {
     double T; ///< time to simulate
     double D; ///< time step
     char   F[256]; ///< a file name
+    int    autotune; ///< steps per timed probe when autotuning the thread layout (0 = off)
+    bool   tasks; ///< overlap the guard cell exchange with OpenMP tasks
+    int    tile; ///< edge length of the tiles for skipping quiescent regions (0 = off)
+    double tiletol; ///< values within this of 0 or 1 count as quiescent
+    int    amrblock; ///< edge length of the refinement blocks in coarse grid points
+    double amrtol; ///< refine blocks where |du/dt| or |grad u| exceeds this fraction of its maximum
+    int    amrregrid; ///< coarse time steps between regrids
+    int    amrratio; ///< refinement ratio: coarse grid spacing over fine grid spacing
+    int    compress; ///< CompressionMode of the snapshots (0 = text output)
+    double compresstol; ///< absolute error bound of the lossy compression
+    char   kernel[32]; ///< name of the update kernel; see @ref kernels.h
+    int    benchkernels; ///< steps to time every kernel with instead of simulating (0 = off)
+    int    order; ///< order of accuracy of the Laplacian (2 or 4)
+    char   iohints[256]; ///< MPI-IO hints for the output file, as "key=value,key=value"
+    double cellsperrank; ///< if positive, choose N to give every process this many cells
+    double nodemem; ///< memory per node in GB to check the configuration against (0 = detect)
+    int    diagnostics; ///< steps between reports of the total mass and the change per step (0 = off)
+    bool   strang; ///< react exactly over half steps before and after the diffusion (Strang splitting)
 };
 
 /// Default values
-const Param defaultParam = { 400, 5.0, 0.2, 100, 10, 0.001, "output.dat" };
+const Param defaultParam = { 400, 5.0, 0.2, 100, 10, 0.001, "output.dat", 0, false, 0, 0.0, 8, 0.05, 4, 2, 0, 1e-6, "omp", 0, 2, "", 0, 0, 0, false };
 
 #endif
@@ -0,0 +1,119 @@
+/// @file pkkfisher3d_amr.cpp
+/// @author Patrick Deng
+/// @date 2025-04-26
+/// @brief Solution of the kpp-fisher PDE in three dimensions with two-level block-structured
+/// adaptive mesh refinement around the front, with MPI and OpenMP parallelization.
+
+#include <rarray>                       // rarray header to use the rtensor class
+#include <iostream>                     // Standard I/O header
+#include <mpi.h>                        // MPI header to distribute the work amonst the processes
+#include "params.h"                     // Parameters header to define the parameters of the simulation
+#include "readcommandline.h"            // Command line header to read the command line arguments
+#include "ticktock.h"                   // Timer header to measure the time of the simulation
+#include "amr.h"                        // Coarse level and fine blocks
+
+///
+/// @brief Solution of the PDE on a coarse grid with r = --amr-ratio times the
+/// grid spacing, refined to the full resolution N where the solution is
+/// steep.  Each coarse step of r^2 D is subcycled with r^2 fine steps of D.
+///
+/// @param p the parameters; see @ref params.h (Param)
+/// @param comm the communicator of the processes sharing the work
+///
+void simulate(const Param& p, MPI_Comm comm)
+{
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if ((p.N-1) % p.amrratio != 0) {
+        if (rank == 0)
+            std::cerr << "The refinement needs N-1 to be a multiple of the refinement ratio\n";
+        MPI_Abort(comm, 1);
+    }
+    // Derived parameters
+    double dtc    = p.amrratio*p.amrratio*p.D;  // coarse time step
+    int    nsteps = p.T / dtc;          // coarse time steps
+    if (nsteps < p.P) {
+        if (rank == 0)
+            std::cerr << "T must hold at least P coarse steps of r^2 D\n";
+        MPI_Abort(comm, 1);
+    }
+    long   uniform = long(p.N-2)*(p.N-2)*(p.N-2);
+    AmrHierarchy amr(p, comm);
+    // Time stepping starts
+    for (int s = 0; s <= nsteps; s++) {
+        // output every so often
+        if (s%(nsteps/p.P) == 0) {      //output every p.P steps
+            amr.snapshot(p.F, s*dtc);
+            long counts[3] = {amr.coarse_cells(), amr.fine_cells(), amr.fine_blocks()}, sums[3];
+            MPI_Reduce(counts, sums, 3, MPI_LONG, MPI_SUM, 0, comm);
+            if (rank == 0)
+                std::cout << "#cells " << sums[0] + sums[1] << " of " << uniform
+                          << " (" << 100.0*(sums[0] + sums[1])/uniform << "%, "
+                          << sums[2] << " fine blocks)\n";
+        }
+        // follow the front
+        if (s > 0 && s%p.amrregrid == 0)
+            amr.regrid();
+        // evolve
+        amr.step();
+    }
+}
+
+///
+/// @brief main function of the program to execute the simulation
+///
+int main(int argc, char* argv[])
+{
+    // Initialize MPI; only the master thread calls MPI
+    int root = 0;
+    int rank;
+    int size;
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    // Synchronize and start the timer.
+    MPI_Barrier(MPI_COMM_WORLD);
+    TickTock stopwatch;
+    if (rank == 0) {
+        stopwatch.tick();
+        std::cout << "\n" << std::string(30, '=')
+                  << "Beginning Calculation" << std::string(30, '=') << "\n\n";
+    }
+
+    // Define defaults settings
+    Param p = defaultParam;
+    // Parse the command line
+    int status;
+    if (rank == root) {
+        status = read_command_line(argc, argv, p);
+        if (status==0) {
+            std::cout << "#P " << p.P << "\n#L " << p.L << "\n"
+                      << "#A " << p.A << "\n#N " << p.N << "\n"
+                      << "#T " << p.T << "\n#D " << p.D << "\n"
+                      << "#F " << p.F << "\n";
+        }
+    }
+    MPI_Bcast(&status, 1, MPI_INT, root, MPI_COMM_WORLD);
+    if (status > 1)
+        MPI_Abort(MPI_COMM_WORLD, status - 1);
+    if (provided < MPI_THREAD_FUNNELED) {
+        if (rank == root)
+            std::cerr << "The MPI library does not support MPI_THREAD_FUNNELED\n";
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    // status == 1 means help was printed and that's all we want.
+    if (status != 1) {
+        // pass the parameters to everyone; assumes p is a "plain-old
+        // datatype", ie., a struct without objects.
+        MPI_Bcast(&p, sizeof(p), MPI_BYTE, root, MPI_COMM_WORLD);
+        simulate(p, MPI_COMM_WORLD);
+    }
+    MPI_Finalize();
+    if (rank == 0) {
+        stopwatch.tock("\nTotal time:     ");
+        std::cout << "\n" << std::string(30, '=')
+                  << "Calculation Complete" << std::string(30, '=') << "\n\n";
+    }
+    return 0;
+}
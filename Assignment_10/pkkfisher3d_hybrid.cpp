@@ -7,18 +7,167 @@
 #include <iostream>                      // Standard I/O header
 #include <mpi.h>                        // MPI header to distribute the work amonst the processes
 #include <omp.h>                        // OpenMP header to parallelize the work on each process
+#include <memory>                       // unique_ptr for the optional tile tracking
+#include <cmath>                        // fabs for comparing the kernels
+#include <cstring>                      // strncpy for the kernel names
+#include <iomanip>                      // formatting of the kernel benchmark
+#include <vector>                       // rows of squares for the diagnostics
+#include <algorithm>                    // the number of benchmark steps
 #include "params.h"                     // Parameters header to define the parameters of the simulation
 #include "output_hybrid.h"                     // Output header to define the output function
 #include "readcommandline.h"            // Command line header to read the command line arguments
 #include "ticktock.h"                   // Timer header to measure the time of the simulation
+#include "autotune.h"                   // Autotuner header to pick the number of threads per process
+#include "tiles.h"                      // Tile header to skip the quiescent parts of the domain
+#include "compress.h"                   // Compression modes of the snapshots
+#include "output_compressed.h"          // Compressed snapshot output
+#include "fd_operators.h"               // Shared finite difference operators
+#include "memory_model.h"               // Weak-scaling sizes and the memory check
+#include "kernels.h"                    // Registry of update kernels
+#include "exact_sum.h"                  // Reproducible sums for the diagnostics
+#include "halo.h"                       // Persistent guard plane exchange
 
 
+/// @brief Diffusion and reaction update of the single i-plane i of u from uold
+/// @param i plane to update (1 <= i <= Ni-2)
+/// @param u the field to update
+/// @param uold the field at the previous time step, including guard planes
+/// @param alpha D/dx^2
+/// @param dt the time step
+static void update_plane(int i, rtensor<double>& u, const rtensor<double>& uold, double alpha, double dt)
+{
+    int Nj = u.extent(1);
+    int Nk = u.extent(2);
+    for (int j = 1; j < Nj-1; j++)
+        for (int k = 1; k < Nk-1; k++)
+            u[i][j][k] = uold[i][j][k]+alpha*fd::Laplacian<3, 2>::point(uold, i, j, k);
+    for (int j = 1; j < Nj-1; j++)
+        for (int k = 1; k < Nk-1; k++)
+            u[i][j][k] += dt * uold[i][j][k] * (1-uold[i][j][k]);
+}
+
+/// @brief One time step with OpenMP tasks, overlapping the guard cell exchange with the interior update
+///
+/// The master thread posts nonblocking sends and receives of the guard
+/// planes of uold, creates one task per interior plane, and the two
+/// boundary planes as tasks depending on the arrival of their guard
+/// plane.  Arrival is signalled through detached tasks whose events the
+/// master thread fulfills while it progresses MPI, so all MPI calls stay
+/// on the master thread (MPI_THREAD_FUNNELED).
+///
+/// @param u the field to update
+/// @param uold the field at the previous time step; its guard planes are filled here
+/// @param alpha D/dx^2
+/// @param dt the time step
+/// @param exchange the guard plane exchange of u and uold
+static void step_tasks(rtensor<double>& u, rtensor<double>& uold, double alpha, double dt,
+                       HaloExchange& exchange)
+{
+    int Ni = u.extent(0);
+    [[maybe_unused]] char halo[2];          // dependence tokens for the left and right guard planes
+    #pragma omp parallel shared(u, uold, alpha, dt, exchange, Ni, halo)
+    #pragma omp master
+    {
+        exchange.start(uold);
+        MPI_Request* recvs = exchange.receives();
+        // placeholders that complete once the guard planes have arrived
+        omp_event_handle_t arrivedleft, arrivedright;
+        #pragma omp task detach(arrivedleft) depend(out: halo[0])
+        { }
+        #pragma omp task detach(arrivedright) depend(out: halo[1])
+        { }
+        // boundary planes wait for their guard planes; a single plane needs both, listed
+        // separately, since a dependence must match those of the placeholders exactly
+        if (Ni == 3) {
+            #pragma omp task depend(in: halo[0], halo[1]) shared(u, uold)
+            update_plane(1, u, uold, alpha, dt);
+        } else {
+            #pragma omp task depend(in: halo[0]) shared(u, uold)
+            update_plane(1, u, uold, alpha, dt);
+            #pragma omp task depend(in: halo[1]) shared(u, uold)
+            update_plane(Ni-2, u, uold, alpha, dt);
+        }
+        // interior planes only need data that is already local
+        for (int i = 2; i < Ni-2; i++) {
+            #pragma omp task firstprivate(i) shared(u, uold)
+            update_plane(i, u, uold, alpha, dt);
+        }
+        // progress the exchange, running tasks in between polls
+        int pending = 2;
+        while (pending > 0) {
+            int which, arrived;
+            MPI_Testany(2, recvs, &which, &arrived, MPI_STATUS_IGNORE);
+            if (arrived && which != MPI_UNDEFINED) {
+                omp_fulfill_event(which == 0 ? arrivedleft : arrivedright);
+                pending--;
+            } else {
+                #pragma omp taskyield
+            }
+        }
+        exchange.wait();
+    } // the implicit barrier waits for all tasks
+}
+
+/// @brief Print the total mass and the root-mean-square change of the last step, on rank 0
+///
+/// Both are exact sums over the interior points, rounded once, so they are
+/// bitwise the same for any number of processes and threads.
+///
+/// @param t the time of u
+/// @param dx the grid spacing
+/// @param u the field, with depth guard planes on either side
+/// @param uold the field one step earlier
+/// @param depth the number of guard planes on either side
+/// @param comm the communicator
+static void diagnostics(double t, double dx, const rtensor<double>& u, const rtensor<double>& uold,
+                        int depth, MPI_Comm comm)
+{
+    int Ni = u.extent(0);
+    int Nj = u.extent(1);
+    int Nk = u.extent(2);
+    ExactSum mass, change;
+    #pragma omp parallel shared(mass, change)
+    {
+        ExactSum mymass, mychange;
+        std::vector<double> squares(Nk-2);
+        #pragma omp for collapse(2) nowait
+        for (int i = depth; i < Ni-depth; i++)
+            for (int j = 1; j < Nj-1; j++) {
+                for (int k = 1; k < Nk-1; k++) {
+                    double d = u[i][j][k] - uold[i][j][k];
+                    squares[k-1] = d*d;
+                }
+                mymass.add(&u[i][j][1], Nk-2);
+                mychange.add(squares.data(), Nk-2);
+            }
+        #pragma omp critical
+        {
+            mass.merge(mymass);
+            change.merge(mychange);
+        }
+    }
+    mass.allreduce(comm);
+    change.allreduce(comm);
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if (rank == 0) {
+        double n = Nj - 2;
+        std::cout << "#diagnostics " << t << std::setprecision(17)
+                  << " mass " << mass.value()*dx*dx*dx
+                  << " change " << std::sqrt(change.value()/(n*n*n))
+                  << std::setprecision(6) << '\n';
+    }
+}
 
 /// @param p the parameters; see @ref params.h (Param)
-void simulate(const Param& p, MPI_Comm comm)
+/// @param comm the communicator of the processes sharing the work
+/// @param probe_steps if positive, only run this many steps without output (used by the autotuner)
+/// @param result if given, receives the final field (used to compare the kernels)
+/// @returns the wall time spent in the time stepping
+double simulate(const Param& p, MPI_Comm comm, int probe_steps = 0, rtensor<double>* result = nullptr)
 {
     // where are we in the communicator
-    int rank, size, left, right, guardleft, guardright;
+    int rank, size, left, right;
     MPI_Comm_rank(comm, &rank);
     MPI_Comm_size(comm, &size);
     left  = rank - 1;
@@ -31,30 +180,40 @@ void simulate(const Param& p, MPI_Comm comm)
     int    nsteps = p.T / p.D;
     double deltax = p.L/(p.N - 1);
     double alpha  = p.D / (deltax*deltax);
-    if (rank==0) std::cerr  << "#alpha " << alpha << "\n";
-    // Create distributed arrays
-    int nguard = 2;
-    int Ni = ((rank+1)*(p.N-nguard))/size - (rank*(p.N-nguard))/size + nguard; // divide system in i, minding guard cells
+    int    laststep = (probe_steps > 0 && probe_steps < nsteps) ? probe_steps : nsteps;
+    // With Strang splitting, the exact reaction over half a step comes before and after the
+    // diffusion.  The half steps at the end of one step and the start of the next are merged
+    // into one full step, unless the state in between is needed for output.
+    fd::LogisticStep halfreaction(p.D/2), fullreaction(p.D);
+    auto complete = [&](int s) {
+        return s%(nsteps/p.P) == 0 || (p.diagnostics > 0 && s%p.diagnostics == 0) || s > laststep;
+    };
+    kernel_function update = kernels[find_kernel(p.kernel)].update;
+    if (rank==0 && probe_steps==0) std::cerr  << "#alpha " << alpha << "\n";
+    // Create distributed arrays; the fourth-order stencil reaches two planes to either side
+    int nguard = p.order;                                   // guard planes, half on each side
+    int depth = nguard/2;
+    int Ni = ((rank+1)*(p.N-2))/size - (rank*(p.N-2))/size + nguard; // divide system in i, minding guard cells
     int Nj = p.N;
     int Nk = p.N;
-    if (Ni < 3) {
+    // the boundary closures of the fourth-order stencil reach four points inward
+    if (Ni - nguard < 2*depth - 1 || (p.order == 4 && p.N < 7)) {
         std::cerr << "Too many processes for the size of the system\n";
         MPI_Abort(comm,1);        
     } 
-    guardleft = 0;
-    guardright = Ni - 1;
     rtensor<double> u(Ni, Nj, Nk); 
-    rtensor<double> uold(Ni, Nj, Nk);
     // Initial state
     u.fill(0.0);
     // Boundary conditions (these points won't change)
     #pragma omp parallel for collapse(2)
     for (int j = 0; j < Nj; j++) {
         for (int k = 0; k < Nk; k++) {
-            if (left == MPI_PROC_NULL)
-                u[0][j][k] = p.A;
-            if (right == MPI_PROC_NULL)
-                u[Ni-1][j][k] = p.A;
+            for (int g = 0; g < depth; g++) {
+                if (left == MPI_PROC_NULL)
+                    u[g][j][k] = p.A;
+                if (right == MPI_PROC_NULL)
+                    u[Ni-1-g][j][k] = p.A;
+            }
         }
     }
     // Initialize the guard cells in the j-dimension
@@ -68,41 +227,152 @@ void simulate(const Param& p, MPI_Comm comm)
     for (int i = 0; i < Ni; i++)
         for (int j = 0; j < Nj; j++)
             u[i][j][0] = u[i][j][Nk-1] = p.A;
+    // The second buffer needs the same boundary values, since the two are swapped every step
+    rtensor<double> uold = u.copy();
+    // Only the interiors of the guard planes change, so only those are exchanged
+    HaloExchange halo(u, uold, depth, left, right, comm);
+    double exchangetime = 0.0;
+    // Optionally track which tiles of the domain can change at all
+    std::unique_ptr<ActiveTiles> tiles;
+    if (p.tile > 0)
+        tiles = std::make_unique<ActiveTiles>(u, p.tile, p.tiletol, p.A);
+    // The output file is opened once; optionally with compressed binary snapshots instead of text
+    double outputtime = MPI_Wtime();
+    std::unique_ptr<CompressedOutput> compressed;
+    std::unique_ptr<TextOutput> text;
+    if (p.compress != COMPRESS_NONE && probe_steps == 0)
+        compressed = std::make_unique<CompressedOutput>(p.F, p.compress, p.compresstol, comm, p.iohints);
+    else if (probe_steps == 0)
+        text = std::make_unique<TextOutput>(p.F, comm, p.iohints);
+    outputtime = MPI_Wtime() - outputtime;
 
     // Time stepping starts
-    for (int s = 0; s <= nsteps; s++) {
+    double starttime = MPI_Wtime();
+    for (int s = 0; s <= laststep; s++) {
         // output every so often
-        if (s%(nsteps/p.P) == 0)        //output every p.P steps
-            output_hybrid(p.F, s*p.D, deltax, u, comm);
+        if (probe_steps==0 && s%(nsteps/p.P) == 0) {      //output every p.P steps
+            double outputstart = MPI_Wtime();
+            if (compressed)
+                compressed->write(s*p.D, deltax, u, depth);
+            else
+                text->write(s*p.D, deltax, u, depth);
+            outputtime += MPI_Wtime() - outputstart;
+            if (tiles && s > 0) {       // the count of the last step
+                long counts[2] = {tiles->active(), tiles->total()}, sums[2];
+                MPI_Reduce(counts, sums, 2, MPI_LONG, MPI_SUM, 0, comm);
+                if (rank == 0)
+                    std::cout << "#active tiles " << sums[0] << " of " << sums[1] << '\n';
+            }
+        }
+        if (probe_steps==0 && p.diagnostics > 0 && s%p.diagnostics == 0)
+            diagnostics(s*p.D, deltax, u, uold, depth, comm);
+        if (p.tasks) {
+            // evolve with the guard cell exchange overlapping the computation
+            std::swap(u, uold);
+            step_tasks(u, uold, alpha, p.D, halo);
+            continue;
+        }
+        if (p.strang && complete(s))
+            react_exact(u, halfreaction, depth);    // the first half step, not merged with the previous one
         // guard cell exchange with neighbours
-        MPI_Sendrecv(&u[1][0][0],          Nj*Nk, MPI_DOUBLE, left, 11,
-                     &u[guardright][0][0], Nj*Nk, MPI_DOUBLE, right,11,
-                     comm, MPI_STATUS_IGNORE);
-        MPI_Sendrecv(&u[Ni-2][0][0],       Nj*Nk, MPI_DOUBLE, right,11,
-                     &u[guardleft][0][0],  Nj*Nk, MPI_DOUBLE, left, 11,
-                     comm, MPI_STATUS_IGNORE);
+        double exchangestart = MPI_Wtime();
+        halo.exchange(u);
+        exchangetime += MPI_Wtime() - exchangestart;
+        if (tiles) {
+            // evolve only the tiles that can change
+            tiles->exchange(left, right, comm);
+            std::swap(u, uold);
+            tiles->swap();
+            tiles->update(u, uold, alpha, p.D);
+            continue;
+        }
         // evolve: first diffuse, then react
         std::swap(u, uold);                         // update solution with Euler explicit step
+        if (p.strang)
+            diffuse_react(u, uold, alpha, complete(s+1) ? halfreaction : fullreaction, p.order,
+                          left == MPI_PROC_NULL, right == MPI_PROC_NULL);
+        else if (p.order == 4)
+            update_fourth_order(u, uold, alpha, p.D, left == MPI_PROC_NULL, right == MPI_PROC_NULL);
+        else
+            update(u, uold, alpha, p.D);
+    }
+    double elapsed = MPI_Wtime() - starttime;
+    if (probe_steps == 0) {
+        // closing the file belongs to the output as well
+        double closestart = MPI_Wtime();
+        compressed.reset();
+        text.reset();
+        outputtime += MPI_Wtime() - closestart;
+        double slowest;
+        MPI_Reduce(&outputtime, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+        if (rank == 0)
+            std::cout << "#output time " << slowest << " sec\n";
+        long bytes = halo.bytes(), maxbytes;
+        MPI_Reduce(&exchangetime, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+        MPI_Reduce(&bytes, &maxbytes, 1, MPI_LONG, MPI_MAX, 0, comm);
+        if (rank == 0 && !p.tasks)
+            std::cout << "#exchange time " << slowest << " sec, " << maxbytes << " bytes per step\n";
+    }
+    // the value in the centre of the cube, a simple measure of accuracy when comparing resolutions
+    int first = 1 + (rank*(p.N-2))/size;
+    int centre = (p.N-1)/2;
+    if (probe_steps == 0 && p.N%2 == 1 && centre >= first && centre < first + Ni - nguard)
+        std::cout << "#centre " << std::setprecision(12) << u[depth+centre-first][centre][centre]
+                  << std::setprecision(6) << '\n';
+    if (result)
+        *result = u.copy();
+    return elapsed;
+}
 
-        /// Diffusion step through OpenMP parallelization
-        for (int i = 1; i < Ni-1; i++)
-        // OpenMP parallelization is applied to the inner j-k loops (collapse(2)) within a serial i loop
-        // This provides cache locality and lower scheduling overhead than collapse(3),
-        // and avoids false sharing by giving each thread exclusive access to a full j-k slice at fixed i.
-            #pragma omp parallel for collapse(2) schedule(static) default(none) shared(u, uold, alpha, Ni, Nj, Nk, i)
-            for (int j = 1; j < Nj-1; j++)
-                for (int k = 1; k < Nk-1; k++)
-                    u[i][j][k] = uold[i][j][k]+alpha*(uold[i-1][j][k]+uold[i+1][j][k]
-                                                      +uold[i][j-1][k]+uold[i][j+1][k]
-                                                      +uold[i][j][k-1]+uold[i][j][k+1]
-                                                      -6*uold[i][j][k] );
-        // reaction term update
-        for (int i = 1; i < Ni-1; i++)
-        // The OMP is parallelized over the i-dimension, and the j and k dimensions are collapsed 
-            # pragma omp parallel for collapse(2) schedule(static) default(none) shared(u, uold, p, Ni, Nj, Nk, i)
-            for (int j = 1; j < Nj-1; j++)
-                for (int k = 1; k < Nk-1; k++)
-                    u[i][j][k] += p.D * uold[i][j][k] * (1-uold[i][j][k]);
+/// @brief Timed probe of simulate() without output, as the autotuner expects
+static double probe(const Param& p, MPI_Comm comm, int probe_steps)
+{
+    return simulate(p, comm, probe_steps);
+}
+
+///
+/// @brief Time every registered kernel on the current decomposition and compare their results
+///
+/// Each kernel runs the same number of steps from the initial state.  Rank
+/// 0 prints the slowest process's time per step, and the largest difference
+/// from the result of the first kernel.
+///
+/// @param p the parameters; p.benchkernels is the number of steps
+/// @param comm the communicator of the processes sharing the work
+///
+void bench_kernels(const Param& p, MPI_Comm comm)
+{
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if (rank == 0)
+        std::cout << "#kernel    time/step (s)   max difference\n";
+    rtensor<double> reference;
+    // simulate() runs steps 0 to the last step, at most the whole run
+    int steps = std::min(p.benchkernels, int(p.T / p.D)) + 1;
+    for (int n = 0; n < nkernels; n++) {
+        Param q = p;
+        strncpy(q.kernel, kernels[n].name, sizeof(q.kernel)-1);
+        q.tasks = false;
+        q.tile = 0;
+        q.order = 2;
+        q.strang = false;
+        rtensor<double> result;
+        double elapsed = simulate(q, comm, p.benchkernels, &result);
+        double difference = 0.0;
+        if (n == 0)
+            reference = result;
+        else
+            for (int i = 1; i < result.extent(0)-1; i++)
+                for (int j = 1; j < result.extent(1)-1; j++)
+                    for (int k = 1; k < result.extent(2)-1; k++)
+                        difference = std::max(difference, std::fabs(result[i][j][k] - reference[i][j][k]));
+        double slowest, maxdifference;
+        MPI_Reduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+        MPI_Reduce(&difference, &maxdifference, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+        if (rank == 0)
+            std::cout << std::left << std::setw(11) << kernels[n].name << std::right
+                      << std::setw(13) << slowest/steps
+                      << std::setw(17) << maxdifference << '\n';
     }
 }
 
@@ -115,7 +385,9 @@ int main(int argc, char* argv[])
     int root = 0;
     int rank;
     int size;
-    MPI_Init(&argc, &argv);
+    // Only the master thread calls MPI, also in the task-based time step
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
     // Synchronize and start the timer.
@@ -133,6 +405,12 @@ int main(int argc, char* argv[])
     int status;
     if (rank == root) {
         status = read_command_line(argc, argv, p);
+        if (status==0 && p.cellsperrank > 0) {
+            p.N = weak_scaling_points(p.cellsperrank, size);
+            double n = p.N - 2;
+            std::cout << "#weak scaling with " << p.cellsperrank << " cells per process: "
+                      << n*n*n/size << " cells per process\n";
+        }
         if (status==0) {
             std::cout << "#P " << p.P << "\n#L " << p.L << "\n"
                       << "#A " << p.A << "\n#N " << p.N << "\n"
@@ -143,12 +421,66 @@ int main(int argc, char* argv[])
     MPI_Bcast(&status, 1, MPI_INT, root, MPI_COMM_WORLD);
     if (status > 1)
         MPI_Abort(MPI_COMM_WORLD, status - 1);
+    if (status == 0 && rank == root && find_kernel(p.kernel) < 0) {
+        std::cerr << "Unknown kernel " << p.kernel << "; the kernels are:\n";
+        for (int n = 0; n < nkernels; n++)
+            std::cerr << "  " << kernels[n].name << "\t" << kernels[n].description << '\n';
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (provided < MPI_THREAD_FUNNELED) {
+        if (rank == root)
+            std::cerr << "The MPI library does not support MPI_THREAD_FUNNELED\n";
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
     // status == 1 means help was printed and that's all we want.
     if (status != 1) {
         // pass the parameters to everyone; assumes p is a "plain-old
         // datatype", ie., a struct without objects.
         MPI_Bcast(&p, sizeof(p), MPI_BYTE, root, MPI_COMM_WORLD);
-        simulate(p, MPI_COMM_WORLD);
+        // refuse configurations whose processes would not fit in the memory of a node together
+        MPI_Comm nodecomm;
+        MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &nodecomm);
+        int noderanks, maxnoderanks;
+        MPI_Comm_size(nodecomm, &noderanks);
+        MPI_Comm_free(&nodecomm);
+        MPI_Allreduce(&noderanks, &maxnoderanks, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+        MemoryEstimate mem = estimate_memory(p, size);
+        int fits = 1;
+        if (rank == root) {
+            double available = p.nodemem > 0 ? p.nodemem*1e9 : node_memory();
+            std::cout << "#memory per process " << mem.total/1e6 << " MB (fields " << mem.fields/1e6
+                      << " MB, output " << mem.output/1e6 << " MB, runtime " << mem.runtime/1e6 << " MB)\n"
+                      << "#memory per node " << maxnoderanks*mem.total/1e9 << " GB of "
+                      << available/1e9 << " GB\n";
+            if (maxnoderanks*mem.total > available) {
+                std::cerr << "Not enough memory per node for N=" << p.N << " on " << size
+                          << " processes; use more nodes or fewer processes per node\n";
+                fits = 0;
+            }
+        }
+        // the others wait for the verdict, so that none of them starts allocating
+        MPI_Bcast(&fits, 1, MPI_INT, root, MPI_COMM_WORLD);
+        if (!fits)
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        // optionally merge processes into fewer ones with more threads; the others idle
+        MPI_Comm simcomm = MPI_COMM_WORLD;
+        if (p.benchkernels > 0) {
+            // compare the kernels instead of simulating
+            bench_kernels(p, MPI_COMM_WORLD);
+            simcomm = MPI_COMM_NULL;
+        } else if (p.autotune > 0)
+            simcomm = autotune(p, MPI_COMM_WORLD, probe);
+        if (simcomm != MPI_COMM_NULL)
+            simulate(p, simcomm);
+        if (p.autotune > 0 && p.benchkernels == 0) {
+            if (simcomm != MPI_COMM_NULL)
+                MPI_Comm_free(&simcomm);
+            relaxed_barrier(MPI_COMM_WORLD);
+        }
+        double peak = peak_memory(), maxpeak;
+        MPI_Reduce(&peak, &maxpeak, 1, MPI_DOUBLE, MPI_MAX, root, MPI_COMM_WORLD);
+        if (rank == root)
+            std::cout << "#peak memory per process " << maxpeak/1e6 << " MB\n";
     }
     MPI_Finalize();    
     if (rank == 0) {
@@ -0,0 +1,127 @@
+/// @file pkkfisher3d_spectral.cpp
+/// @author Patrick Deng
+/// @date 2025-04-22
+/// @brief Solution of the kpp-fisher PDE in three dimensions with an MPI-distributed pseudo-spectral method:
+/// exact diffusion of the sine modes and exact logistic reaction, combined by operator splitting.
+
+#include <rarray>                       // rarray header to use the rtensor class
+#include <iostream>                     // Standard I/O header
+#include <cmath>                        // exp for the reaction propagator
+#include <mpi.h>                        // MPI header to distribute the work amonst the processes
+#include "params.h"                     // Parameters header to define the parameters of the simulation
+#include "output.h"                     // Output header to define the output function
+#include "readcommandline.h"            // Command line header to read the command line arguments
+#include "ticktock.h"                   // Timer header to measure the time of the simulation
+#include "spectral.h"                   // Spectral diffusion and exact reaction
+
+///
+/// @brief Solution of the PDE by splitting each time step into an exact
+/// reaction step and an exact diffusion step.  Since neither is limited by
+/// stability, the time step only needs to resolve the dynamics.  With
+/// --strang, the reaction is split in halves before and after the
+/// diffusion, which makes the splitting error second order in time.
+///
+/// @param p the parameters; see @ref params.h (Param)
+/// @param comm the communicator of the processes sharing the work
+///
+void simulate(const Param& p, MPI_Comm comm)
+{
+    // where are we in the communicator
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    // Derived parameters
+    int    nsteps = p.T / p.D;
+    double deltax = p.L/(p.N - 1);
+    double expdt  = std::exp(-p.D);
+    double exphalf = std::exp(-p.D/2);         // for the half steps of Strang splitting
+    int    interval = nsteps/p.P;
+    // Create distributed arrays; the same division in i as the finite difference code
+    int nguard = 2;
+    int Ni = ((rank+1)*(p.N-nguard))/size - (rank*(p.N-nguard))/size + nguard;
+    int Nj = p.N;
+    int Nk = p.N;
+    if (Ni < 3) {
+        std::cerr << "Too many processes for the size of the system\n";
+        MPI_Abort(comm,1);
+    }
+    // Initial state: zero inside, A on the boundaries (the guard planes are not used)
+    rtensor<double> u(Ni, Nj, Nk);
+    u.fill(p.A);
+    for (int i = 1; i < Ni-1; i++)
+        for (int j = 1; j < Nj-1; j++)
+            for (int k = 1; k < Nk-1; k++)
+                u[i][j][k] = 0.0;
+    SpectralDiffusion diffusion(p.N - nguard, Ni - nguard, p.L, p.D, comm);
+    // Time stepping starts
+    for (int s = 0; s <= nsteps; s++) {
+        // output every so often
+        if (s%interval == 0)        //output every p.P steps
+            output(p.F, s*p.D, deltax, u, comm);
+        if (p.strang) {
+            // react over half a step, diffuse, and react over the other half; the half steps of
+            // consecutive steps are merged unless there is output in between
+            if (s%interval == 0)
+                calc_reaction(exphalf, u);
+            diffusion.apply(u, p.A);
+            calc_reaction(((s+1)%interval == 0 || s == nsteps) ? exphalf : expdt, u);
+            continue;
+        }
+        // evolve: first react, then diffuse
+        calc_reaction(expdt, u);
+        diffusion.apply(u, p.A);
+    }
+}
+
+///
+/// @brief main function of the program to execute the simulation
+///
+int main(int argc, char* argv[])
+{
+    // Initialize MPI
+    int root = 0;
+    int rank;
+    int size;
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    // Synchronize and start the timer.
+    MPI_Barrier(MPI_COMM_WORLD);
+    TickTock stopwatch;
+    if (rank == 0) {
+        stopwatch.tick();
+        std::cout << "\n" << std::string(30, '=')
+                  << "Beginning Calculation" << std::string(30, '=') << "\n\n";
+    }
+
+    // Define defaults settings
+    Param p = defaultParam;
+    // Parse the command line
+    int status;
+    if (rank == root) {
+        status = read_command_line(argc, argv, p);
+        if (status==0) {
+            std::cout << "#P " << p.P << "\n#L " << p.L << "\n"
+                      << "#A " << p.A << "\n#N " << p.N << "\n"
+                      << "#T " << p.T << "\n#D " << p.D << "\n"
+                      << "#F " << p.F << "\n";
+        }
+    }
+    MPI_Bcast(&status, 1, MPI_INT, root, MPI_COMM_WORLD);
+    if (status > 1)
+        MPI_Abort(MPI_COMM_WORLD, status - 1);
+    // status == 1 means help was printed and that's all we want.
+    if (status != 1) {
+        // pass the parameters to everyone; assumes p is a "plain-old
+        // datatype", ie., a struct without objects.
+        MPI_Bcast(&p, sizeof(p), MPI_BYTE, root, MPI_COMM_WORLD);
+        simulate(p, MPI_COMM_WORLD);
+    }
+    MPI_Finalize();
+    if (rank == 0) {
+        stopwatch.tock("\nTotal time:     ");
+        std::cout << "\n" << std::string(30, '=')
+                  << "Calculation Complete" << std::string(30, '=') << "\n\n";
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+/// @file pktread.cpp
+/// @author Patrick Deng
+/// @date 2025-04-29
+/// @brief Fast reader for the five-column text output files: extracts a snapshot, a plane or
+/// a strided subsample without reading the rest of the file, and reports its statistics or
+/// writes it in the same text format.  Optionally reports its largest difference from the
+/// same points of another text output file, such as that of another solver.
+
+#include <iostream>                     // Standard I/O header
+#include <fstream>                      // writing the extracted records
+#include <iomanip>                      // formatting of the output
+#include <sstream>                      // formatting of the output
+#include <algorithm>                    // min and max of the values
+#include <cmath>                        // differences from the reference
+#include <memory>                       // the optional reference file
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <boost/program_options.hpp>    // command line parsing
+#include "textsnapshot.h"               // memory-mapped access to the file
+#include "ticktock.h"                   // timing of the extraction
+
+/// @brief convert a value to ascii with given width and precision, as output() does
+static std::string double_to_string(double value, int width, int precision)
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(precision);
+    oss << std::setw(width) << std::setfill('0') << value;
+    return oss.str();
+}
+
+///
+/// @brief main function of the reader
+///
+int main(int argc, char* argv[])
+{
+    using boost::program_options::value;
+    std::string filename, textname, plane, refname;
+    int snapshot = -2;
+    int stride = 1;
+    boost::program_options::options_description desc("Options for pktread");
+    desc.add_options()
+        ("help,h",                                   "Print help message")
+        ("file",       value<std::string>(&filename), "text output file")
+        ("snapshot,s", value<int>(&snapshot),         "only this snapshot, counted from 0 (-1 for the last one)")
+        ("plane,p",    value<std::string>(&plane),    "only this plane, e.g. x=10 for the 11th interior plane in x")
+        ("stride",     value<int>(&stride),           "only every stride-th point in each direction")
+        ("text,o",     value<std::string>(&textname), "write the extracted records to this file in the text format")
+        ("reference,r", value<std::string>(&refname), "also report the largest difference from this text output file");
+    boost::program_options::positional_options_description positional;
+    positional.add("file", 1);
+    boost::program_options::variables_map args;
+    try {
+        store(boost::program_options::command_line_parser(argc, argv)
+              .options(desc).positional(positional).run(), args);
+        notify(args);
+    }
+    catch (...) {
+        std::cerr << "ERROR in command line arguments!\n" << desc;
+        return 2;
+    }
+    if (args.count("help") || filename.empty()) {
+        std::cout << "Usage:\n    " << argv[0] << " FILE [OPTIONS]\n" << desc;
+        return args.count("help") ? 0 : 2;
+    }
+    try {
+        TickTock tt;
+        tt.tick();
+        TextSnapshotFile file(filename);
+        int n = file.n();
+        // the box to extract
+        int lo[3] = {0, 0, 0};
+        int hi[3] = {n, n, n};
+        if (!plane.empty()) {
+            std::string axes("xyz");
+            std::size_t d = axes.find(plane[0]);
+            int index = -1;
+            if (plane.size() > 2 && plane[1] == '=')
+                index = std::stoi(plane.substr(2));
+            if (d == std::string::npos || index < 0 || index >= n) {
+                std::cerr << "ERROR: --plane must be x=I, y=I or z=I with 0 <= I < " << n << "\n";
+                return 2;
+            }
+            lo[d] = index;
+            hi[d] = index + 1;
+        }
+        if (stride < 1) {
+            std::cerr << "ERROR: --stride must be positive\n";
+            return 2;
+        }
+        int first = 0, last = file.snapshots() - 1;
+        if (snapshot == -1)
+            first = last;
+        else if (snapshot >= 0)
+            first = last = snapshot;
+        std::unique_ptr<TextSnapshotFile> reference;
+        if (!refname.empty()) {
+            reference = std::make_unique<TextSnapshotFile>(refname);
+            if (reference->n() != n || reference->snapshots() <= last)
+                throw std::runtime_error("the reference file has a different grid or too few snapshots");
+        }
+        std::ofstream text;
+        if (!textname.empty())
+            text.open(textname);
+        int numwidth = TextSnapshotFile::colwidth - 1;
+        int precision = 11;
+        double dx = file.dx();
+        std::cout << "#n " << n << " snapshots " << file.snapshots() << " dx " << dx << "\n";
+        std::cout << "#time          values           min           max          mean"
+                  << (reference ? "      maxerror" : "") << "\n";
+        for (int s = first; s <= last; s++) {
+            double t = file.time(s);
+            std::vector<double> values = file.extract(s, lo, hi, stride);
+            double sum = 0.0;
+            for (double v : values)
+                sum += v;
+            std::cout << std::setw(10) << t << std::setw(11) << values.size()
+                      << std::setw(14) << *std::min_element(values.begin(), values.end())
+                      << std::setw(14) << *std::max_element(values.begin(), values.end())
+                      << std::setw(14) << sum/values.size();
+            if (reference) {
+                if (std::fabs(reference->time(s) - t) > 1e-9)
+                    throw std::runtime_error("snapshot " + std::to_string(s) + " of the reference is at another time");
+                std::vector<double> refvalues = reference->extract(s, lo, hi, stride);
+                double maxerror = 0.0;
+                for (std::size_t m = 0; m < values.size(); m++)
+                    maxerror = std::max(maxerror, std::fabs(values[m] - refvalues[m]));
+                std::cout << std::setw(14) << maxerror;
+            }
+            std::cout << "\n";
+            if (text.is_open()) {
+                std::size_t m = 0;
+                for (int i = lo[0]; i < hi[0]; i += stride) {
+                    for (int j = lo[1]; j < hi[1]; j += stride)
+                        for (int k = lo[2]; k < hi[2]; k += stride)
+                            text << double_to_string(t, numwidth, precision) << ' '
+                                 << double_to_string((i+1)*dx, numwidth, precision) << ' '
+                                 << double_to_string((j+1)*dx, numwidth, precision) << ' '
+                                 << double_to_string((k+1)*dx, numwidth, precision) << ' '
+                                 << double_to_string(values[m++], numwidth, precision) << '\n';
+                    text << '\n';
+                }
+            }
+        }
+        std::cout << "#extracted in " << tt.silent_tock() << " sec\n";
+    }
+    catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
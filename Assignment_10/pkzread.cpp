@@ -0,0 +1,154 @@
+/// @file pkzread.cpp
+/// @author Patrick Deng
+/// @date 2025-04-27
+/// @brief Reader for the compressed snapshot files of pkkfisher3d_hybrid (--compress):
+/// reports the compression ratio of every snapshot, optionally converts the file to the
+/// five-column text format, and optionally reports the error against a text output file.
+
+#include <iostream>                     // Standard I/O header
+#include <fstream>                      // reading and writing files
+#include <iomanip>                      // formatting of the text output
+#include <sstream>                      // formatting of the text output
+#include <cmath>                        // fabs for the errors
+#include <cstring>                      // memcmp for the magic number
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>    // command line parsing
+#include "compress.h"                   // decompression of the planes
+#include "output_compressed.h"          // file layout
+
+/// @brief convert a value to ascii with given width and precision, as output() does
+static std::string double_to_string(double value, int width, int precision)
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(precision);
+    oss << std::setw(width) << std::setfill('0') << value;
+    return oss.str();
+}
+
+/// @brief read the value column of the next record of a text output file; false at its end
+static bool next_value(std::ifstream& in, double& value)
+{
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        double t, x, y, z;
+        if (fields >> t >> x >> y >> z >> value)
+            return true;
+    }
+    return false;
+}
+
+///
+/// @brief main function of the reader
+///
+int main(int argc, char* argv[])
+{
+    using boost::program_options::value;
+    std::string filename, textname, refname;
+    boost::program_options::options_description desc("Options for pkzread");
+    desc.add_options()
+        ("help,h",                                  "Print help message")
+        ("file",      value<std::string>(&filename), "compressed snapshot file")
+        ("text,o",    value<std::string>(&textname), "write the snapshots to this file in the text format")
+        ("reference,r", value<std::string>(&refname), "text output of an uncompressed run to compare with");
+    boost::program_options::positional_options_description positional;
+    positional.add("file", 1);
+    boost::program_options::variables_map args;
+    try {
+        store(boost::program_options::command_line_parser(argc, argv)
+              .options(desc).positional(positional).run(), args);
+        notify(args);
+    }
+    catch (...) {
+        std::cerr << "ERROR in command line arguments!\n" << desc;
+        return 2;
+    }
+    if (args.count("help") || filename.empty()) {
+        std::cout << "Usage:\n    " << argv[0] << " FILE [OPTIONS]\n" << desc;
+        return args.count("help") ? 0 : 2;
+    }
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open " << filename << "\n";
+        return 1;
+    }
+    std::ofstream text;
+    if (!textname.empty())
+        text.open(textname);
+    std::ifstream ref;
+    if (!refname.empty()) {
+        ref.open(refname);
+        if (!ref) {
+            std::cerr << "Cannot open " << refname << "\n";
+            return 1;
+        }
+    }
+    int colwidth = 16;
+    int numwidth = colwidth - 1;
+    int precision = 11;
+    long long rawtotal = 0, compressedtotal = 0;
+    double maxerror = 0.0;
+    std::cout << "#time            raw bytes    compressed      ratio" << (ref.is_open() ? "    max error" : "") << "\n";
+    SnapshotHeader header;
+    while (in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        if (std::memcmp(header.magic, "PKZ1", 4) != 0) {
+            std::cerr << "Not a compressed snapshot file: " << filename << "\n";
+            return 1;
+        }
+        std::vector<unsigned long long> table(header.nplanes);
+        in.read(reinterpret_cast<char*>(table.data()), sizeof(unsigned long long)*header.nplanes);
+        std::size_t n = header.n;
+        std::vector<double> values(n*n);
+        std::vector<char> compressed;
+        long long raw = 0;
+        long long size = sizeof(header) + sizeof(unsigned long long)*header.nplanes;
+        double snaperror = 0.0;
+        for (int i = 0; i < header.nplanes; i++) {
+            compressed.resize(table[i]);
+            if (!in.read(compressed.data(), table[i])
+                || !decompress_values(compressed.data(), table[i], values.data(), values.size(),
+                                      header.mode, header.tol)) {
+                std::cerr << "Corrupt plane " << i << " of the snapshot at time " << header.t << "\n";
+                return 1;
+            }
+            raw += sizeof(double)*values.size();
+            size += table[i];
+            for (std::size_t j = 0; j < n; j++) {
+                for (std::size_t k = 0; k < n; k++) {
+                    double v = values[j*n + k];
+                    if (text.is_open())
+                        text << double_to_string(header.t, numwidth, precision) << ' '
+                             << double_to_string((i+1)*header.dx, numwidth, precision) << ' '
+                             << double_to_string((j+1)*header.dx, numwidth, precision) << ' '
+                             << double_to_string((k+1)*header.dx, numwidth, precision) << ' '
+                             << double_to_string(v, numwidth, precision) << '\n';
+                    double r;
+                    if (ref.is_open()) {
+                        if (!next_value(ref, r)) {
+                            std::cerr << "The reference file " << refname << " is too short\n";
+                            return 1;
+                        }
+                        snaperror = std::max(snaperror, std::fabs(v - r));
+                    }
+                }
+            }
+            if (text.is_open())
+                text << '\n';
+        }
+        std::cout << std::setw(12) << header.t << std::setw(15) << raw << std::setw(14) << size
+                  << std::setw(11) << std::setprecision(4) << double(raw)/size << std::setprecision(6);
+        if (ref.is_open())
+            std::cout << std::setw(13) << snaperror;
+        std::cout << "\n";
+        rawtotal += raw;
+        compressedtotal += size;
+        maxerror = std::max(maxerror, snaperror);
+    }
+    std::cout << "#total      " << std::setw(15) << rawtotal << std::setw(14) << compressedtotal
+              << std::setw(11) << std::setprecision(4) << double(rawtotal)/compressedtotal << std::setprecision(6);
+    if (ref.is_open())
+        std::cout << std::setw(13) << maxerror;
+    std::cout << "\n";
+    return 0;
+}
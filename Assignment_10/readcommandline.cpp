@@ -6,7 +6,9 @@
 ///
 
 #include "readcommandline.h"
+#include "compress.h"
 #include <iostream>
+#include <cstdlib>
 #include <boost/program_options.hpp>
 
 int read_command_line(int argc, char* argv[], Param& param)
@@ -14,6 +16,11 @@ int read_command_line(int argc, char* argv[], Param& param)
     using boost::program_options::value;
     boost::program_options::options_description desc("Options for answerA");
     std::string filename("output.dat");
+    std::string compression("none");
+    std::string kernel(param.kernel);
+    // the hints can also come from the environment, so that job scripts can set them for all runs
+    const char* envhints = std::getenv("PKKFISHER_IO_HINTS");
+    std::string iohints(envhints ? envhints : param.iohints);
     desc.add_options()
         ("help,h",                              "Print help message")
         ("snapshots,P",value<int>   (&param.P), "number of snapshots to output")
@@ -22,17 +29,99 @@ int read_command_line(int argc, char* argv[], Param& param)
         ("points,N",   value<int>   (&param.N), "number of grid points")
         ("time,T",     value<double>(&param.T), "time to simulate")
         ("deltat,D",   value<double>(&param.D), "time step")
-        ("filename,F", value<std::string>(&filename), "output file");
+        ("filename,F", value<std::string>(&filename), "output file")
+        ("autotune",   value<int>   (&param.autotune)->implicit_value(20),
+                       "pick the fastest threads per rank with timed probes of this many steps (hybrid only)")
+        ("tasks",      boost::program_options::bool_switch(&param.tasks),
+                       "overlap the guard cell exchange with OpenMP tasks (hybrid only)")
+        ("tile",       value<int>   (&param.tile)->implicit_value(16),
+                       "skip tiles of this edge length that cannot change (hybrid only)")
+        ("tile-tol",   value<double>(&param.tiletol),
+                       "values within this of 0 or 1 count as unchanging for --tile")
+        ("amr-block",  value<int>   (&param.amrblock),
+                       "edge length of the refinement blocks in coarse points (amr only)")
+        ("amr-tol",    value<double>(&param.amrtol),
+                       "refine blocks where |du/dt| or |grad u| exceeds this fraction of its maximum (amr only)")
+        ("amr-regrid", value<int>   (&param.amrregrid),
+                       "coarse time steps between regrids (amr only)")
+        ("amr-ratio",  value<int>   (&param.amrratio),
+                       "coarse grid spacing over fine grid spacing; N-1 must be a multiple of it (amr only)")
+        ("compress",   value<std::string>(&compression),
+                       "write compressed binary snapshots: none, lossless or lossy (hybrid only)")
+        ("compress-tol", value<double>(&param.compresstol),
+                       "absolute error bound of the lossy compression")
+        ("kernel",     value<std::string>(&kernel),
+                       "update kernel: omp, serial, fused, tiled or simd (hybrid only)")
+        ("bench-kernels", value<int>(&param.benchkernels)->implicit_value(20),
+                       "time every update kernel for this many steps and compare their results (hybrid only)")
+        ("order",      value<int>   (&param.order),
+                       "order of the Laplacian: 2 (7-point) or 4 (13-point) (hybrid only)")
+        ("io-hints",   value<std::string>(&iohints),
+                       "MPI-IO hints for the output file, e.g. cb_nodes=2,cb_buffer_size=16777216 "
+                       "(default: $PKKFISHER_IO_HINTS) (hybrid only)")
+        ("cells-per-rank", value<double>(&param.cellsperrank),
+                       "weak scaling: choose N so that every process has about this many cells (hybrid only)")
+        ("node-mem",   value<double>(&param.nodemem),
+                       "memory per node in GB that a run may use (default: detected) (hybrid only)")
+        ("diagnostics", value<int>(&param.diagnostics)->implicit_value(1),
+                       "report the total mass and the change per step every this many steps, "
+                       "independent of the processes and threads (hybrid only)")
+        ("strang",     boost::program_options::bool_switch(&param.strang),
+                       "Strang splitting: exact reaction over half steps around the diffusion (hybrid and spectral only)");
     boost::program_options::variables_map args;
     try {
         store(parse_command_line(argc, argv, desc), args);
         notify(args);
         strncpy(param.F, filename.c_str(), sizeof(param.F)-1);
+        strncpy(param.kernel, kernel.c_str(), sizeof(param.kernel)-1);
+        strncpy(param.iohints, iohints.c_str(), sizeof(param.iohints)-1);
     }
     catch (...) {
         std::cerr << "ERROR in command line arguments!\n" << desc;
         return 2;
     }
+    if ((param.tasks || param.tile > 0) && kernel != defaultParam.kernel) {
+        std::cerr << "ERROR: --tasks and --tile have their own update loops and cannot be combined with --kernel\n";
+        return 2;
+    }
+    if (param.tasks && param.tile > 0) {
+        std::cerr << "ERROR: --tasks and --tile cannot be combined\n";
+        return 2;
+    }
+    if (param.strang && (param.tasks || param.tile > 0)) {
+        std::cerr << "ERROR: --strang cannot be combined with --tasks or --tile\n";
+        return 2;
+    }
+    if (param.order != 2 && param.order != 4) {
+        std::cerr << "ERROR: --order must be 2 or 4\n";
+        return 2;
+    }
+    if (param.order == 4 && (param.tasks || param.tile > 0)) {
+        std::cerr << "ERROR: --order 4 cannot be combined with --tasks or --tile\n";
+        return 2;
+    }
+    if (compression == "none")
+        param.compress = COMPRESS_NONE;
+    else if (compression == "lossless")
+        param.compress = COMPRESS_LOSSLESS;
+    else if (compression == "lossy" && param.compresstol > 0)
+        param.compress = COMPRESS_LOSSY;
+    else {
+        std::cerr << "ERROR: --compress must be none, lossless or lossy, the latter with a positive --compress-tol\n";
+        return 2;
+    }
+    if (param.diagnostics < 0) {
+        std::cerr << "ERROR: --diagnostics must not be negative\n";
+        return 2;
+    }
+    if (param.amrblock < 1 || param.amrregrid < 1 || param.amrratio < 2) {
+        std::cerr << "ERROR: --amr-block and --amr-regrid must be positive, and --amr-ratio at least 2\n";
+        return 2;
+    }
+    if (param.amrtol < 0 || param.amrtol > 1) {
+        std::cerr << "ERROR: --amr-tol must be between 0 and 1\n";
+        return 2;
+    }
     if (args.count("help")) {
         std::cout << "Usage:\n    " << argv[0] << " [OPTIONS]\n" << desc;
         return 1;
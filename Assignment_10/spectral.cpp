@@ -0,0 +1,139 @@
+/// @file spectral.cpp
+/// @author Patrick Deng
+/// @date 2025-04-22
+/// @brief Exact spectral diffusion with slab FFTs and an MPI_Alltoallv transpose, and the exact logistic reaction.
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+/// See @ref spectral.h
+#include "spectral.h"
+#include <cmath>
+
+SpectralDiffusion::SpectralDiffusion(int n, int ni, double L, double dt, MPI_Comm comm)
+  : n_(n), ni_(ni), comm_(comm)
+{
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    // after the transpose, the j-direction is divided the same way the i-direction is
+    jstart_ = (rank*n)/size;
+    nj_ = ((rank+1)*n)/size - jstart_;
+    planes_ = rvector<double>(ni_*n_*n_);
+    sendbuf_ = rvector<double>(ni_*n_*n_);
+    lines_ = rvector<double>(n_*nj_*n_);
+    // block sizes for the transpose: to process r go our planes restricted to its j-range,
+    // from process q come its planes restricted to our j-range
+    rvector<int> allni(size);
+    MPI_Allgather(&ni_, 1, MPI_INT, allni.data(), 1, MPI_INT, comm);
+    sendcounts_ = rvector<int>(size);
+    senddispls_ = rvector<int>(size);
+    recvcounts_ = rvector<int>(size);
+    recvdispls_ = rvector<int>(size);
+    int sendpos = 0, recvpos = 0;
+    for (int r = 0; r < size; r++) {
+        int njr = ((r+1)*n)/size - (r*n)/size;
+        sendcounts_[r] = ni_*njr*n_;
+        senddispls_[r] = sendpos;
+        recvcounts_[r] = allni[r]*nj_*n_;
+        recvdispls_[r] = recvpos;
+        sendpos += sendcounts_[r];
+        recvpos += recvcounts_[r];
+    }
+    // Decay of each sine mode over one time step; the DST-I applied twice
+    // multiplies by 2(n+1) per direction, which is divided out here too
+    decayi_ = rvector<double>(n_);
+    decayj_ = rvector<double>(nj_);
+    decayk_ = rvector<double>(n_);
+    double norm = 2.0*(n_+1);
+    for (int m = 0; m < n_; m++) {
+        double k = M_PI*(m+1)/L;
+        decayi_[m] = decayk_[m] = std::exp(-dt*k*k)/norm;
+    }
+    for (int jl = 0; jl < nj_; jl++) {
+        double k = M_PI*(jstart_+jl+1)/L;
+        decayj_[jl] = std::exp(-dt*k*k)/norm;
+    }
+    // In-place transforms: 2d over (j,k) on every local plane, and 1d over i on every local line.
+    // A DST-I is its own inverse (up to normalization), so the same plans serve both directions.
+    fftw_r2r_kind sine[2] = {FFTW_RODFT00, FFTW_RODFT00};
+    int planedims[2] = {n_, n_};
+    planes_plan_ = fftw_plan_many_r2r(2, planedims, ni_,
+                                      planes_.data(), nullptr, 1, n_*n_,
+                                      planes_.data(), nullptr, 1, n_*n_,
+                                      sine, FFTW_ESTIMATE);
+    int linedims[1] = {n_};
+    lines_plan_ = fftw_plan_many_r2r(1, linedims, nj_*n_,
+                                     lines_.data(), nullptr, nj_*n_, 1,
+                                     lines_.data(), nullptr, nj_*n_, 1,
+                                     sine, FFTW_ESTIMATE);
+}
+
+SpectralDiffusion::~SpectralDiffusion()
+{
+    fftw_destroy_plan(planes_plan_);
+    fftw_destroy_plan(lines_plan_);
+}
+
+void SpectralDiffusion::transpose_forward()
+{
+    int size;
+    MPI_Comm_size(comm_, &size);
+    // pack the planes by destination, each destination getting its range of j
+    int pos = 0;
+    for (int r = 0; r < size; r++) {
+        int jr = (r*n_)/size;
+        int njr = ((r+1)*n_)/size - jr;
+        for (int i = 0; i < ni_; i++)
+            for (int jk = 0; jk < njr*n_; jk++)
+                sendbuf_[pos++] = planes_[(i*n_ + jr)*n_ + jk];
+    }
+    // the blocks from successive processes are successive ranges of i
+    MPI_Alltoallv(sendbuf_.data(), sendcounts_.data(), senddispls_.data(), MPI_DOUBLE,
+                  lines_.data(), recvcounts_.data(), recvdispls_.data(), MPI_DOUBLE, comm_);
+}
+
+void SpectralDiffusion::transpose_backward()
+{
+    int size;
+    MPI_Comm_size(comm_, &size);
+    MPI_Alltoallv(lines_.data(), recvcounts_.data(), recvdispls_.data(), MPI_DOUBLE,
+                  sendbuf_.data(), sendcounts_.data(), senddispls_.data(), MPI_DOUBLE, comm_);
+    int pos = 0;
+    for (int r = 0; r < size; r++) {
+        int jr = (r*n_)/size;
+        int njr = ((r+1)*n_)/size - jr;
+        for (int i = 0; i < ni_; i++)
+            for (int jk = 0; jk < njr*n_; jk++)
+                planes_[(i*n_ + jr)*n_ + jk] = sendbuf_[pos++];
+    }
+}
+
+void SpectralDiffusion::apply(rtensor<double>& u, double A)
+{
+    // work with v = u - A, which vanishes on the boundaries
+    for (int i = 0; i < ni_; i++)
+        for (int j = 0; j < n_; j++)
+            for (int k = 0; k < n_; k++)
+                planes_[(i*n_ + j)*n_ + k] = u[i+1][j+1][k+1] - A;
+    fftw_execute(planes_plan_);
+    transpose_forward();
+    fftw_execute(lines_plan_);
+    // exact propagation of every mode
+    for (int i = 0; i < n_; i++)
+        for (int jl = 0; jl < nj_; jl++)
+            for (int k = 0; k < n_; k++)
+                lines_[(i*nj_ + jl)*n_ + k] *= decayi_[i]*decayj_[jl]*decayk_[k];
+    fftw_execute(lines_plan_);
+    transpose_backward();
+    fftw_execute(planes_plan_);
+    for (int i = 0; i < ni_; i++)
+        for (int j = 0; j < n_; j++)
+            for (int k = 0; k < n_; k++)
+                u[i+1][j+1][k+1] = planes_[(i*n_ + j)*n_ + k] + A;
+}
+
+void calc_reaction(double expdt, rtensor<double>& u)
+{
+    for (int i = 1; i < u.extent(0)-1; i++)
+        for (int j = 1; j < u.extent(1)-1; j++)
+            for (int k = 1; k < u.extent(2)-1; k++)
+                u[i][j][k] = u[i][j][k]/(u[i][j][k] + (1-u[i][j][k])*expdt);
+}
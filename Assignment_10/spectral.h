@@ -0,0 +1,80 @@
+/// @file spectral.h
+///
+/// Distributed pseudo-spectral propagators for the 3D KPP-Fisher equation
+/// on a slab decomposition.
+///
+/// The diffusion step is exact: with v = u - A vanishing on the Dirichlet
+/// boundaries, v is expanded in sine modes (FFTW's RODFT00, a type-I
+/// discrete sine transform) and each mode is multiplied by
+/// exp(-dt (kx^2 + ky^2 + kz^2)), with k = pi m / L.  The transforms along
+/// j and k are done locally on every i-plane of a process; the transform
+/// along the distributed i-direction is done after an MPI_Alltoallv
+/// transpose that gives each process complete i-lines for a range of j.
+/// The reaction step u' = u (1-u) is integrated exactly as well, so dt
+/// is not limited by stability.
+///
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+///
+#ifndef SPECTRALH
+#define SPECTRALH
+
+#include <mpi.h>
+#include <rarray>
+#include <fftw3.h>
+
+///
+/// @brief Exact diffusion propagator over one time step on a slab-decomposed cube
+///
+class SpectralDiffusion
+{
+  public:
+    ///
+    /// @brief Set up the transforms, transposes and decay factors
+    ///
+    /// @param n    number of interior points in each direction (N-2)
+    /// @param ni   number of interior i-planes on this process
+    /// @param L    length of the interval
+    /// @param dt   time step
+    /// @param comm MPI communicator over which the i-direction is divided
+    ///
+    SpectralDiffusion(int n, int ni, double L, double dt, MPI_Comm comm);
+    ~SpectralDiffusion();
+    SpectralDiffusion(const SpectralDiffusion&) = delete;
+    SpectralDiffusion& operator=(const SpectralDiffusion&) = delete;
+
+    ///
+    /// @brief Diffuse u exactly over one time step
+    ///
+    /// @param u field with one guard/boundary layer on every side, as in simulate()
+    /// @param A value of u on the boundaries
+    ///
+    void apply(rtensor<double>& u, double A);
+
+  private:
+    /// copy the planes into the transposed layout (i-lines for a range of j) and back
+    void transpose_forward();
+    void transpose_backward();
+
+    int n_;                         ///< interior points per direction
+    int ni_;                        ///< local number of i-planes
+    int nj_;                        ///< local number of j-lines after the transpose
+    int jstart_;                    ///< first global j-index owned after the transpose
+    MPI_Comm comm_;
+    rvector<double> planes_;        ///< [ni][n][n] local slab of v = u - A
+    rvector<double> lines_;         ///< [n][nj][n] complete i-lines after the transpose
+    rvector<double> sendbuf_;       ///< packed blocks for MPI_Alltoallv
+    rvector<int> sendcounts_, senddispls_, recvcounts_, recvdispls_;
+    rvector<double> decayi_, decayj_, decayk_; ///< per-direction factors exp(-dt k^2), with normalization
+    fftw_plan planes_plan_;         ///< in-place 2d DST-I over (j,k) of every plane
+    fftw_plan lines_plan_;          ///< in-place 1d DST-I over i of every line
+};
+
+///
+/// @brief Exact solution of u' = u (1-u) over one time step on the interior of u
+///
+/// @param expdt precomputed exp(-dt)
+/// @param u field with one guard/boundary layer on every side
+///
+void calc_reaction(double expdt, rtensor<double>& u);
+
+#endif
@@ -9,6 +9,7 @@
 module load gcc/12.3 rarray/2.8.0 boost/1.85.0 openmpi/4.1.5
 module list
 
-exec="./pkkfisher3d"
+exec="./pkkfisher3d_hybrid"
+export OMP_NUM_THREADS=1
 timer="/usr/bin/time"
-"$timer" -f "%es" mpirun -np 40 "$exec" -P 10 -L 15.0 -A 0.2 -N 200 -T 10 -D 0.000125 -F output_mpi_40.dat
+"$timer" -f "%es" mpirun -np 40 "$exec" -P 10 -L 15.0 -A 0.2 -N 200 -T 10 -D 0.000125 -F output_mpi_40.dat --kernel serial
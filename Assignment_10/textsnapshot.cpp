@@ -0,0 +1,115 @@
+/// @file textsnapshot.cpp
+/// @author Patrick Deng
+/// @date 2025-04-29
+/// @brief Memory-mapped, random access reading of the five-column text output files.
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+/// See @ref textsnapshot.h
+#include "textsnapshot.h"
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+double parse_column(const char* field, int width)
+{
+    const char* end = field + width;
+    double value = 0.0;
+    auto result = std::from_chars(field, end, value);
+    if (result.ptr != end) {
+        // a negative number is padded as "000-1.5", so parse from the sign
+        const char* minus = static_cast<const char*>(std::memchr(field, '-', width));
+        if (minus == nullptr || std::from_chars(minus, end, value).ptr != end)
+            throw std::runtime_error("Malformed column '" + std::string(field, width) + "'");
+    }
+    return value;
+}
+
+TextSnapshotFile::TextSnapshotFile(const std::string& fn)
+    : data_(nullptr), size_(0), n_(0), nsnap_(0), dx_(0.0), slicebytes_(0), snapbytes_(0)
+{
+    int fd = open(fn.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Cannot open " + fn);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < reclen) {
+        close(fd);
+        throw std::runtime_error("Not a text output file: " + fn);
+    }
+    size_ = st.st_size;
+    void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        throw std::runtime_error("Cannot map " + fn);
+    data_ = static_cast<const char*>(map);
+    // the first i-slice ends in a blank line after n*n records; probe one byte per candidate n
+    std::size_t nn = 1;
+    while (nn*nn*reclen < size_ && data_[nn*nn*reclen] != '\n')
+        nn++;
+    if (data_[reclen-1] != '\n' || nn*nn*reclen >= size_ || data_[nn*nn*reclen-1] != '\n') {
+        munmap(map, size_);
+        throw std::runtime_error("Not a text output file: " + fn);
+    }
+    n_ = nn;
+    slicebytes_ = nn*nn*reclen + 1;
+    snapbytes_ = slicebytes_*n_;
+    nsnap_ = size_/snapbytes_;
+    dx_ = parse_column(data_ + colwidth, colwidth-1);
+}
+
+TextSnapshotFile::~TextSnapshotFile()
+{
+    munmap(const_cast<char*>(data_), size_);
+}
+
+const char* TextSnapshotFile::record(int s, int i, int j, int k) const
+{
+    if (s < 0 || s >= nsnap_ || i < 0 || i >= n_ || j < 0 || j >= n_ || k < 0 || k >= n_)
+        throw std::out_of_range("Point outside of the snapshots in the file");
+    return data_ + s*snapbytes_ + i*slicebytes_ + (std::size_t(j)*n_ + k)*reclen;
+}
+
+double TextSnapshotFile::time(int s) const
+{
+    return parse_column(record(s, 0, 0, 0), colwidth-1);
+}
+
+double TextSnapshotFile::value(int s, int i, int j, int k) const
+{
+    return parse_column(record(s, i, j, k) + 4*colwidth, colwidth-1);
+}
+
+std::vector<double> TextSnapshotFile::extract(int s, const int lo[3], const int hi[3], int stride) const
+{
+    int count[3];
+    for (int d = 0; d < 3; d++) {
+        if (lo[d] < 0 || hi[d] > n_ || lo[d] >= hi[d] || stride < 1)
+            throw std::out_of_range("Box outside of the snapshots in the file");
+        count[d] = (hi[d] - lo[d] + stride - 1)/stride;
+    }
+    record(s, lo[0], lo[1], lo[2]);          // checks s
+    std::vector<double> values(std::size_t(count[0])*count[1]*count[2]);
+    // one (i,j) row per iteration; an exception cannot leave the parallel region, so remember it
+    bool malformed = false;
+    #pragma omp parallel for collapse(2) schedule(static) reduction(||:malformed)
+    for (int a = 0; a < count[0]; a++) {
+        for (int b = 0; b < count[1]; b++) {
+            const char* row = data_ + s*snapbytes_ + std::size_t(lo[0] + a*stride)*slicebytes_
+                              + std::size_t(lo[1] + b*stride)*n_*reclen + 4*colwidth;
+            double* out = &values[(std::size_t(a)*count[1] + b)*count[2]];
+            for (int c = 0; c < count[2]; c++) {
+                try {
+                    out[c] = parse_column(row + std::size_t(lo[2] + c*stride)*reclen, colwidth-1);
+                }
+                catch (const std::runtime_error&) {
+                    malformed = true;
+                }
+            }
+        }
+    }
+    if (malformed)
+        throw std::runtime_error("Malformed record in snapshot " + std::to_string(s));
+    return values;
+}
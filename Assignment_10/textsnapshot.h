@@ -0,0 +1,96 @@
+/// @file textsnapshot.h
+///
+/// Random access to the five-column text files written by output() and
+/// output_hybrid(), for post-processing.
+///
+/// The layout of these files is fixed: every record (t, x, y, z, value)
+/// takes 5 columns of 16 characters, the last one ending in a newline,
+/// and every i-slice of n x n records is followed by a blank line.  A
+/// snapshot of n^3 interior points therefore takes n*(80*n*n+1) bytes,
+/// and the position of any record follows from its indices.  The file is
+/// memory-mapped, so that only the pages holding the requested records
+/// are read from disk.
+///
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+///
+#ifndef TEXTSNAPSHOTH
+#define TEXTSNAPSHOTH
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+///
+/// @brief A memory-mapped text output file
+///
+class TextSnapshotFile
+{
+  public:
+    /// width of a column in characters
+    static const int colwidth = 16;
+    /// length of a record in characters
+    static const int reclen = 5*colwidth;
+
+    ///
+    /// @brief Map the file and determine its layout from the first i-slice
+    ///
+    /// @param fn the name of the file
+    ///
+    /// @throws std::runtime_error if the file cannot be mapped or does not have the layout of a text output file
+    ///
+    explicit TextSnapshotFile(const std::string& fn);
+    ~TextSnapshotFile();
+    TextSnapshotFile(const TextSnapshotFile&) = delete;
+    TextSnapshotFile& operator=(const TextSnapshotFile&) = delete;
+
+    /// @brief interior points per direction
+    int n() const { return n_; }
+
+    /// @brief number of complete snapshots in the file
+    int snapshots() const { return nsnap_; }
+
+    /// @brief grid spacing, from the x column of the first record
+    double dx() const { return dx_; }
+
+    /// @brief time of snapshot s
+    double time(int s) const;
+
+    /// @brief value at interior point (i,j,k), counted from 0, of snapshot s
+    double value(int s, int i, int j, int k) const;
+
+    ///
+    /// @brief Values of every stride-th point of a box of snapshot s, in (i,j,k) order
+    ///
+    /// The records are parsed in parallel with OpenMP.
+    ///
+    /// @param s      the snapshot
+    /// @param lo     lowest (i,j,k) of the box, counted from 0
+    /// @param hi     one past the highest (i,j,k) of the box
+    /// @param stride step in each direction
+    ///
+    std::vector<double> extract(int s, const int lo[3], const int hi[3], int stride) const;
+
+  private:
+    /// @brief start of the record of point (i,j,k) of snapshot s
+    const char* record(int s, int i, int j, int k) const;
+
+    const char* data_;
+    std::size_t size_;
+    int n_;
+    int nsnap_;
+    double dx_;
+    std::size_t slicebytes_;     ///< bytes per i-slice, including the blank line
+    std::size_t snapbytes_;      ///< bytes per snapshot
+};
+
+///
+/// @brief Parse a fixed-width column as written by output()
+///
+/// Handles the zero padding in front of a minus sign, which std::setfill('0') puts there.
+///
+/// @param field start of the column
+/// @param width number of characters in the column, without separator
+///
+double parse_column(const char* field, int width);
+
+#endif
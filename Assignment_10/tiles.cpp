@@ -0,0 +1,145 @@
+/// @file tiles.cpp
+/// @author Patrick Deng
+/// @date 2025-04-24
+/// @brief Skipping of quiescent tiles in the time step of the hybrid solver.
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+/// See @ref tiles.h
+#include "tiles.h"
+#include "fd_operators.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+/// tile states: all values 0, all 1 (within the tolerance), or anything else;
+/// NEAR is added when the values are within the tolerance but not all exactly the constant
+static const signed char ZERO = 0, ONE = 1, MIXED = -1, NEAR = 2;
+
+/// @brief the constant of a state, regardless of NEAR, or MIXED
+static signed char constant(signed char state) { return (state == MIXED) ? MIXED : state % NEAR; }
+
+/// @brief first index of tile t along a direction whose interior is 1..n-2
+static int tile_begin(int t, int tile) { return 1 + t*tile; }
+
+/// @brief one past the last index of tile t along a direction with n points
+static int tile_end(int t, int tile, int n) { return std::min(1 + (t+1)*tile, n-1); }
+
+/// @brief state of the values of a in the box [i0,i1) x [j0,j1) x [k0,k1), up to a tolerance tol
+static signed char box_state(const rtensor<double>& a, int i0, int i1, int j0, int j1, int k0, int k1, double tol)
+{
+    double c;
+    if (std::fabs(a[i0][j0][k0]) <= tol)
+        c = 0.0;
+    else if (std::fabs(a[i0][j0][k0] - 1.0) <= tol)
+        c = 1.0;
+    else
+        return MIXED;
+    bool near = false;
+    for (int i = i0; i < i1; i++)
+        for (int j = j0; j < j1; j++)
+            for (int k = k0; k < k1; k++) {
+                if (std::fabs(a[i][j][k] - c) > tol)
+                    return MIXED;
+                near = near || a[i][j][k] != c;
+            }
+    return ((c == 0.0) ? ZERO : ONE) + (near ? NEAR : 0);
+}
+
+ActiveTiles::ActiveTiles(const rtensor<double>& u, int tile, double tol, double A)
+  : tile_(tile),
+    tol_(tol),
+    nti_((u.extent(0)-2 + tile-1)/tile),
+    ntj_((u.extent(1)-2 + tile-1)/tile),
+    ntk_((u.extent(2)-2 + tile-1)/tile),
+    boundary_((A == 0.0) ? ZERO : (A == 1.0) ? ONE : MIXED),
+    active_(0),
+    state_(nti_, ntj_, ntk_),
+    ghostleft_(ntj_, ntk_),
+    ghostright_(ntj_, ntk_)
+{
+    // until a neighbour tells otherwise, the guard planes are the boundary
+    ghostleft_.fill(boundary_);
+    ghostright_.fill(boundary_);
+    for (int ti = 0; ti < nti_; ti++)
+        for (int tj = 0; tj < ntj_; tj++)
+            for (int tk = 0; tk < ntk_; tk++)
+                state_[ti][tj][tk] = box_state(u, tile_begin(ti, tile_), tile_end(ti, tile_, u.extent(0)),
+                                                  tile_begin(tj, tile_), tile_end(tj, tile_, u.extent(1)),
+                                                  tile_begin(tk, tile_), tile_end(tk, tile_, u.extent(2)), tol_);
+    // the two time levels start out identical
+    stateold_ = state_.copy();
+}
+
+void ActiveTiles::exchange(int left, int right, MPI_Comm comm)
+{
+    int layer = ntj_*ntk_;
+    MPI_Sendrecv(&state_[0][0][0],      layer, MPI_SIGNED_CHAR, left, 12,
+                 &ghostright_[0][0],    layer, MPI_SIGNED_CHAR, right,12,
+                 comm, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(&state_[nti_-1][0][0], layer, MPI_SIGNED_CHAR, right,12,
+                 &ghostleft_[0][0],     layer, MPI_SIGNED_CHAR, left, 12,
+                 comm, MPI_STATUS_IGNORE);
+}
+
+void ActiveTiles::swap()
+{
+    std::swap(state_, stateold_);
+}
+
+signed char ActiveTiles::neighbour(int ti, int tj, int tk) const
+{
+    if (tj < 0 || tj >= ntj_ || tk < 0 || tk >= ntk_)
+        return boundary_;
+    if (ti < 0)
+        return ghostleft_[tj][tk];
+    if (ti >= nti_)
+        return ghostright_[tj][tk];
+    return stateold_[ti][tj][tk];
+}
+
+void ActiveTiles::update(rtensor<double>& u, const rtensor<double>& uold, double alpha, double dt)
+{
+    int Ni = u.extent(0);
+    int Nj = u.extent(1);
+    int Nk = u.extent(2);
+    long active = 0;
+    // Tiles are independent; dynamic scheduling since skipped tiles cost next to nothing
+    #pragma omp parallel for collapse(3) schedule(dynamic) reduction(+:active)
+    for (int ti = 0; ti < nti_; ti++) {
+        for (int tj = 0; tj < ntj_; tj++) {
+            for (int tk = 0; tk < ntk_; tk++) {
+                int i0 = tile_begin(ti, tile_), i1 = tile_end(ti, tile_, Ni);
+                int j0 = tile_begin(tj, tile_), j1 = tile_end(tj, tile_, Nj);
+                int k0 = tile_begin(tk, tile_), k1 = tile_end(tk, tile_, Nk);
+                signed char c = constant(stateold_[ti][tj][tk]);
+                bool quiescent = c != MIXED
+                    && constant(neighbour(ti-1, tj, tk)) == c && constant(neighbour(ti+1, tj, tk)) == c
+                    && constant(neighbour(ti, tj-1, tk)) == c && constant(neighbour(ti, tj+1, tk)) == c
+                    && constant(neighbour(ti, tj, tk-1)) == c && constant(neighbour(ti, tj, tk+1)) == c;
+                if (quiescent) {
+                    // the update would reproduce c (exactly, if tol is 0); set this buffer to exactly c
+                    // unless it already is, so that a skipped tile does not keep values from two steps ago
+                    if (state_[ti][tj][tk] != c) {
+                        for (int i = i0; i < i1; i++)
+                            for (int j = j0; j < j1; j++)
+                                for (int k = k0; k < k1; k++)
+                                    u[i][j][k] = c;
+                        state_[ti][tj][tk] = c;
+                    }
+                    continue;
+                }
+                active++;
+                // same diffusion and reaction updates as the untiled time step
+                for (int i = i0; i < i1; i++)
+                    for (int j = j0; j < j1; j++)
+                        for (int k = k0; k < k1; k++)
+                            u[i][j][k] = uold[i][j][k]+alpha*fd::Laplacian<3, 2>::point(uold, i, j, k);
+                for (int i = i0; i < i1; i++)
+                    for (int j = j0; j < j1; j++)
+                        for (int k = k0; k < k1; k++)
+                            u[i][j][k] += dt * uold[i][j][k] * (1-uold[i][j][k]);
+                state_[ti][tj][tk] = box_state(u, i0, i1, j0, j1, k0, k1, tol_);
+            }
+        }
+    }
+    active_ = active;
+}
@@ -0,0 +1,90 @@
+/// @file tiles.h
+///
+/// Active-region tracking for the hybrid solver: the interior of each
+/// process's slab is covered by cubic tiles, and tiles that cannot change
+/// during a time step are skipped.
+///
+/// A tile is quiescent when all of its values are exactly 0 (not yet
+/// reached by the front) or exactly 1 (saturated), and its six face
+/// neighbours hold the same constant: the 7-point stencil and the reaction
+/// term then leave every value unchanged, so skipping it gives bitwise the
+/// same result as updating it.  The state of every tile is recomputed when
+/// the tile is updated, and the states of the tile layers next to the
+/// neighbouring processes are exchanged along with the guard cells.
+///
+/// With explicit time stepping, nonzero values spread one grid point per
+/// step, so exactly-zero regions disappear after a few hundred steps.  A
+/// tolerance can therefore be given: values within it of 0 or 1 count as
+/// 0 or 1, and skipped tiles are set to exactly that constant in both time
+/// levels, which introduces errors of at most the tolerance.
+///
+/// Part of assignment 10 of the PHY1610 Winter 2025 course.
+///
+#ifndef TILESH
+#define TILESH
+
+#include <mpi.h>
+#include <rarray>
+
+///
+/// @brief Per-tile activity states of the two time levels of the solver
+///
+class ActiveTiles
+{
+  public:
+    ///
+    /// @brief Divide the interior of u into tiles and determine their initial state
+    ///
+    /// @param u    the initial field with guard and boundary layers
+    /// @param tile edge length of the tiles in grid points
+    /// @param tol  values within tol of 0 or 1 count as quiescent (0 for bitwise exact results)
+    /// @param A    value of u on the Dirichlet boundaries
+    ///
+    ActiveTiles(const rtensor<double>& u, int tile, double tol, double A);
+
+    ///
+    /// @brief Send the states of the edge tile layers of the current field to the neighbours
+    ///
+    /// Call together with the guard cell exchange, before swap().
+    ///
+    /// @param left  rank of the left neighbour (or MPI_PROC_NULL)
+    /// @param right rank of the right neighbour (or MPI_PROC_NULL)
+    /// @param comm  the communicator
+    ///
+    void exchange(int left, int right, MPI_Comm comm);
+
+    /// @brief Swap the states of the two time levels, along with the fields
+    void swap();
+
+    ///
+    /// @brief Diffusion and reaction update of all non-quiescent tiles of u from uold
+    ///
+    /// @param u     the field to update
+    /// @param uold  the field at the previous time step, including guard planes
+    /// @param alpha D/dx^2
+    /// @param dt    the time step
+    ///
+    void update(rtensor<double>& u, const rtensor<double>& uold, double alpha, double dt);
+
+    /// @brief Number of tiles computed in the last update
+    long active() const { return active_; }
+
+    /// @brief Total number of tiles on this process
+    long total() const { return long(nti_)*ntj_*ntk_; }
+
+  private:
+    /// state of the tile (ti,tj,tk) of the previous time level, or of its out-of-slab substitute
+    signed char neighbour(int ti, int tj, int tk) const;
+
+    int tile_;                              ///< tile edge length
+    double tol_;                            ///< tolerance for counting values as 0 or 1
+    int nti_, ntj_, ntk_;                   ///< number of tiles in each direction
+    signed char boundary_;                  ///< state of the Dirichlet boundary
+    long active_;                           ///< tiles computed in the last update
+    rtensor<signed char> state_;            ///< states of the tiles of the current field
+    rtensor<signed char> stateold_;         ///< states of the tiles of the previous field
+    rmatrix<signed char> ghostleft_;        ///< states of the left neighbour's last tile layer
+    rmatrix<signed char> ghostright_;       ///< states of the right neighbour's first tile layer
+};
+
+#endif
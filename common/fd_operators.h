@@ -0,0 +1,268 @@
+/// @file fd_operators.h
+/// @author Patrick Deng
+/// @date 2025-04-30
+/// @brief Header-only finite difference operators for the KPP-Fisher solvers of assignments 5, 6 and 10.
+///
+/// The solvers used to spell out the same discretization in their own way:
+/// a dense matrix G and a banded G_banded in assignment 5, the exact logistic
+/// step in assignment 6, and inline 7-point updates in assignment 10.  This
+/// header holds the one copy of each:
+/// - fd::Stencil<Order>: constexpr weights of the second difference, central
+///   and, for order 4, the one-sided closure next to a boundary,
+/// - fd::Laplacian<Dim,Order>: the Laplacian on a grid with spacing dx and
+///   Dirichlet boundaries, with a common apply(in, out) and a pointwise
+///   point() for solvers that fuse it into their own loops,
+/// - fd::logistic_rate and fd::LogisticStep: the Fisher reaction u(1-u), and
+///   its exact solution over a time step.
+///
+/// The containers are template parameters; anything indexed as u[i]
+/// (1D) or u[i][j][k] (3D) with size() or extent() works, such as rarrays.
+/// The weighted sums of order 2 are written out in the order the solvers
+/// always used, so that they reproduce their earlier results bit for bit.
+///
+/// Shared by the PHY1610 Winter 2025 assignments; include with -I../common.
+///
+#ifndef FD_OPERATORS_H
+#define FD_OPERATORS_H
+
+#include <cmath>
+#include <cstddef>
+
+namespace fd {
+
+///
+/// @brief Weights of the second difference of a given order of accuracy, in units of 1/dx^2
+///
+template<int Order> struct Stencil;
+
+/// @brief (u[i-1] - 2u[i] + u[i+1])
+template<> struct Stencil<2> {
+    static constexpr int radius = 1;                                   ///< points on each side
+    static constexpr double central[3] = {1.0, -2.0, 1.0};             ///< weights at offsets -1..1
+};
+
+/// @brief (-u[i-2] + 16u[i-1] - 30u[i] + 16u[i+1] - u[i+2])/12, with a one-sided closure next to a boundary
+template<> struct Stencil<4> {
+    static constexpr int radius = 2;                                   ///< points on each side
+    static constexpr double central[5] = {-1.0/12, 16.0/12, -30.0/12, 16.0/12, -1.0/12}; ///< weights at offsets -2..2
+    /// weights at offsets -1..4 for the point just above a boundary point (mirrored just below one)
+    static constexpr double closure[6] = {10.0/12, -15.0/12, -4.0/12, 14.0/12, -6.0/12, 1.0/12};
+};
+
+///
+/// @brief Second difference of order 4 along a line through p with the given stride
+///
+/// @param p        pointer to the point
+/// @param stride   distance to the next point along the line
+/// @param nearlow  whether p[-stride] is a boundary point
+/// @param nearhigh whether p[stride] is a boundary point
+/// @param sum      value to add the terms to one by one, to chain the directions of a Laplacian
+///
+inline double second_difference4(const double* p, std::ptrdiff_t stride, bool nearlow, bool nearhigh,
+                                 double sum = 0.0)
+{
+    if (nearlow)
+        for (int m = 0; m < 6; m++)
+            sum += Stencil<4>::closure[m]*p[(m-1)*stride];
+    else if (nearhigh)
+        for (int m = 0; m < 6; m++)
+            sum += Stencil<4>::closure[m]*p[(1-m)*stride];
+    else
+        for (int m = 0; m < 5; m++)
+            sum += Stencil<4>::central[m]*p[(m-2)*stride];
+    return sum;
+}
+
+///
+/// @brief The Laplacian in Dim dimensions to the given order on a uniform grid
+///
+template<int Dim, int Order> class Laplacian;
+
+///
+/// @brief The second derivative on a line of n points, with Dirichlet values at both ends
+///
+template<int Order> class Laplacian<1, Order>
+{
+  public:
+    static constexpr int radius = Stencil<Order>::radius;   ///< points on each side
+
+    /// @param dx grid spacing
+    explicit Laplacian(double dx) : scale_(1.0/(dx*dx)) {}
+
+    /// @brief 1/dx^2, the factor the weights are multiplied with
+    double scale() const { return scale_; }
+
+    /// @brief the weighted sum at interior point i, in units of 1/dx^2
+    template<class Vec> static double point(const Vec& u, int i)
+    {
+        int n = u.size();
+        if constexpr (Order == 2)
+            return u[i-1] - 2.0*u[i] + u[i+1];
+        else
+            return second_difference4(&u[i], 1, i == 1, i == n-2);
+    }
+
+    /// @brief out = (Laplacian of in) at the interior points; the boundary points of out are not touched
+    template<class Vec> void apply(const Vec& in, Vec& out) const
+    {
+        int n = in.size();
+        for (int i = 1; i < n-1; i++)
+            out[i] = scale_*point(in, i);
+    }
+
+    ///
+    /// @brief Fill a dense n x n matrix with the operator
+    ///
+    /// The rows of the two boundary points are those of the identity, and all other elements are set.
+    ///
+    template<class Mat> void assemble_dense(Mat& G) const
+    {
+        int n = G.extent(0);
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                G[i][j] = 0.0;
+        for (int i = 1; i < n-1; i++)
+            for (int m = 0; m < nweights(i, n); m++)
+                G[i][i+offset(i, n, m)] = scale_*weight(i, n, m);
+        G[0][0] = 1.0;
+        G[n-1][n-1] = 1.0;
+    }
+
+    ///
+    /// @brief Fill a matrix in the row-major band storage of cblas_dgbmv, with kl = ku = bandwidth()
+    ///
+    /// Element (i,j) of the operator goes to B[i][bandwidth() + j - i]; B must have n rows and
+    /// 2*bandwidth()+1 columns.  The boundary rows are those of the identity.
+    ///
+    template<class Mat> void assemble_banded(Mat& B) const
+    {
+        int n = B.extent(0);
+        int kl = bandwidth();
+        for (int i = 0; i < n; i++)
+            for (int b = 0; b < 2*kl+1; b++)
+                B[i][b] = 0.0;
+        for (int i = 1; i < n-1; i++)
+            for (int m = 0; m < nweights(i, n); m++)
+                B[i][kl + offset(i, n, m)] = scale_*weight(i, n, m);
+        B[0][kl] = 1.0;
+        B[n-1][kl] = 1.0;
+    }
+
+    /// @brief number of sub- (or super-) diagonals of the matrix, including the boundary closures
+    static constexpr int bandwidth() { return Order == 2 ? 1 : 4; }
+
+  private:
+    /// @brief number of points in the stencil of row i
+    static int nweights(int i, int n)
+    {
+        if constexpr (Order == 2)
+            return 3;
+        else
+            return (i == 1 || i == n-2) ? 6 : 5;
+    }
+    /// @brief offset of point m of the stencil of row i
+    static int offset(int i, int n, int m)
+    {
+        if constexpr (Order == 2)
+            return m-1;
+        else
+            return i == 1 ? m-1 : (i == n-2 ? 1-m : m-2);
+    }
+    /// @brief weight of point m of the stencil of row i
+    static double weight(int i, int n, int m)
+    {
+        if constexpr (Order == 2)
+            return Stencil<2>::central[m];
+        else
+            return (i == 1 || i == n-2) ? Stencil<4>::closure[m] : Stencil<4>::central[m];
+    }
+
+    double scale_;
+};
+
+///
+/// @brief The Laplacian on a box of points, with Dirichlet values on its faces
+///
+/// In i, the box may be one slab of a decomposed domain, whose outer planes
+/// are guard planes rather than boundaries; point() is then told which of its
+/// ends are real boundaries.  Order 4 needs two guard planes on such ends.
+///
+template<int Order> class Laplacian<3, Order>
+{
+  public:
+    static constexpr int radius = Stencil<Order>::radius;   ///< points on each side
+
+    /// @param dx grid spacing
+    explicit Laplacian(double dx) : scale_(1.0/(dx*dx)) {}
+
+    /// @brief 1/dx^2, the factor the weights are multiplied with
+    double scale() const { return scale_; }
+
+    ///
+    /// @brief the weighted sum at interior point (i,j,k), in units of 1/dx^2
+    ///
+    /// @param lowboundary  whether plane i-1 is the boundary at the low end (only used by order 4)
+    /// @param highboundary whether plane i+1 is the boundary at the high end (only used by order 4)
+    ///
+    template<class Field> static double point(const Field& u, int i, int j, int k,
+                                                     bool lowboundary = false, bool highboundary = false)
+    {
+        if constexpr (Order == 2) {
+            return u[i-1][j][k]+u[i+1][j][k]
+                  +u[i][j-1][k]+u[i][j+1][k]
+                  +u[i][j][k-1]+u[i][j][k+1]
+                  -6*u[i][j][k];
+        } else {
+            int nj = u.extent(1);
+            int nk = u.extent(2);
+            std::ptrdiff_t planesize = std::ptrdiff_t(nj)*nk;
+            const double* c = &u[i][j][k];
+            double sum = second_difference4(c, planesize, lowboundary, highboundary);
+            sum = second_difference4(c, nk, j == 1, j == nj-2, sum);
+            return second_difference4(c, 1, k == 1, k == nk-2, sum);
+        }
+    }
+
+    /// @brief out = (Laplacian of in) at the interior points of a whole domain; its faces are not touched
+    template<class Field> void apply(const Field& in, Field& out) const
+    {
+        int ni = in.extent(0);
+        int nj = in.extent(1);
+        int nk = in.extent(2);
+        for (int i = 1; i < ni-1; i++)
+            for (int j = 1; j < nj-1; j++)
+                for (int k = 1; k < nk-1; k++)
+                    out[i][j][k] = scale_*point(in, i, j, k, i == 1, i == ni-2);
+    }
+
+  private:
+    double scale_;
+};
+
+/// @brief The Fisher reaction term u(1-u)
+inline double logistic_rate(double u)
+{
+    return u * (1.0 - u);
+}
+
+///
+/// @brief The exact solution of du/dt = u(1-u) over a fixed time step
+///
+/// u(t+dt) = u/(u + (1-u) e^{-dt}), with the exponential computed once.
+///
+class LogisticStep
+{
+  public:
+    /// @param dt the time step
+    explicit LogisticStep(double dt) : decay_(std::exp(-dt)) {}
+
+    /// @brief u after one time step
+    double operator()(double u) const { return u / (u + (1-u)*decay_); }
+
+  private:
+    double decay_;
+};
+
+} // namespace fd
+
+#endif